@@ -5,7 +5,6 @@
 
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <map>
 #include <queue>
@@ -16,8 +15,70 @@
 #include <tuple>
 #include <limits>
 #include <algorithm>
+#include <climits>
+#include <sstream>
+#include <random>
+
+#include "comum/leitor_instancia.hpp"
+#include "comum/grafo_csr.hpp"
+#include "comum/oraculo_chaves.hpp"
+#include "comum/apsp.hpp"
+#include "comum/expansor_caminhos.hpp"
+#include "comum/distancias_dinamicas.hpp"
+#include "comum/condensacao.hpp"
+#include "comum/indice_vizinhos.hpp"
+#include "comum/portfolio.hpp"
+#include "comum/split.hpp"
+#include "comum/snapshot_instancia.hpp"
+#include "comum/pipeline.hpp"
+#include "comum/reordenacao.hpp"
 
 const int INF = INT_MAX;
+// Tamanho das listas de serviços mais próximos usadas pela regra de distância
+const int K_VIZINHOS = 16;
+// Regra da elipse: vale quando a capacidade restante cai abaixo deste fator
+// vezes a demanda média dos serviços
+const double FATOR_ELIPSE = 1.5;
+
+// Critérios de escolha do path-scanning. Os dois de ordem fixa ignoram a
+// posição do veículo; os demais escolhem entre os serviços mais próximos e
+// diferem só no desempate.
+enum class RegraEscolha
+{
+    MaisProximo,       // empate pelo menor id
+    OrdemDemanda,      // maior demanda primeiro
+    OrdemCustoDemanda, // menor custo/demanda primeiro
+    LongeDeposito,     // empate pelo fim mais longe do depósito
+    PertoDeposito,     // empate pelo fim mais perto do depósito
+    MaiorCustoDemanda, // empate pela maior razão custo/demanda
+    MenorCustoDemanda, // empate pela menor razão custo/demanda
+    DependeCarga,      // longe do depósito até meia carga, perto depois
+    Aleatorio,         // empate sorteado
+    TourGigante        // tour gigante + Split (comum/split.hpp); semente 0 = vizinho mais próximo
+};
+
+struct VarianteRegra
+{
+    RegraEscolha regra;
+    bool elipse = false; // perto do fim da carga, só serviços dentro da elipse
+    unsigned semente = 0;
+};
+
+// Variantes determinísticas do portfólio, sempre executadas; as três
+// primeiras são as regras originais
+const std::vector<VarianteRegra> REGRAS_FIXAS = {
+    {RegraEscolha::MaisProximo},
+    {RegraEscolha::OrdemDemanda},
+    {RegraEscolha::OrdemCustoDemanda},
+    {RegraEscolha::LongeDeposito},
+    {RegraEscolha::PertoDeposito},
+    {RegraEscolha::MaiorCustoDemanda},
+    {RegraEscolha::MenorCustoDemanda},
+    {RegraEscolha::DependeCarga},
+    {RegraEscolha::MaisProximo, true},
+    {RegraEscolha::DependeCarga, true},
+    {RegraEscolha::TourGigante},
+};
 
 struct Servico
 {
@@ -35,7 +96,6 @@ struct NoRequerido
 };
 
 typedef std::pair<int, int> Par;
-typedef std::vector<std::vector<Par>> ListaAdj;
 
 class Instancia
 {
@@ -48,14 +108,24 @@ private:
     std::vector<NoRequerido> nosRequeridos;
     std::vector<Servico> arestasRequeridas;
     std::vector<Servico> arcosRequeridos;
-    std::map<int, int> mapaDemanda;
-    std::map<int, int> mapaCusto;
-    ListaAdj grafo;
-    std::vector<std::vector<int>> distancias;
+    // Atributos dos serviços em vetores densos indexados pelo id (1..S)
+    std::vector<int> mapaDemanda, mapaCusto, origemServico, destinoServico;
+    GrafoCSR grafo;
+    Condensacao condensacao;
+    OraculoChaves distancias;
+    IndiceVizinhos vizinhos;
+    SnapshotInstancia snapshot;
+    Reordenacao reordenacao;
+    bool reordenar = false;
+    ConfiguracaoPortfolio portfolio;
 
     using Rota = std::vector<std::tuple<int, int, int, int, int>>;
     std::vector<Rota> melhorSolucao;
 
+    // Criado na primeira alteração de custo; linhas da tabela à espera de recálculo
+    std::unique_ptr<AtualizadorDistancias> atualizador;
+    std::vector<int> linhasPendentes;
+
     void resetarServicos()
     {
         for (auto &no : nosRequeridos)
@@ -66,235 +136,592 @@ private:
             a.atendido = false;
     }
 
+    int qtdServicos() const { return (int)mapaDemanda.size() - 1; }
+
     void construirMapas()
     {
+        int total = (int)(nosRequeridos.size() + arestasRequeridas.size() + arcosRequeridos.size());
+        mapaDemanda.assign(total + 1, 0);
+        mapaCusto.assign(total + 1, 0);
+        origemServico.assign(total + 1, 0);
+        destinoServico.assign(total + 1, 0);
         for (const auto &no : nosRequeridos)
         {
             mapaDemanda[no.servico_id] = no.demanda;
             mapaCusto[no.servico_id] = no.custo;
+            origemServico[no.servico_id] = destinoServico[no.servico_id] = no.id;
         }
-        for (const auto &e : arestasRequeridas)
-        {
-            mapaDemanda[e.id] = e.demanda;
-            mapaCusto[e.id] = e.custo;
-        }
-        for (const auto &a : arcosRequeridos)
-        {
-            mapaDemanda[a.id] = a.demanda;
-            mapaCusto[a.id] = a.custo;
-        }
+        for (const auto *lista : {&arestasRequeridas, &arcosRequeridos})
+            for (const auto &s : *lista)
+            {
+                mapaDemanda[s.id] = s.demanda;
+                mapaCusto[s.id] = s.custo;
+                origemServico[s.id] = s.origem;
+                destinoServico[s.id] = s.destino;
+            }
     }
 
-    void dijkstra(int origem, std::vector<int> &dist)
+    // Para o depósito e o fim de cada serviço, os K_VIZINHOS serviços cujo
+    // início está mais perto (pela tabela de distâncias)
+    void construirIndiceVizinhos(PoolThreads *pool)
     {
-        dist.assign(qtdVertices + 1, INF);
-        dist[origem] = 0;
-        std::priority_queue<Par, std::vector<Par>, std::greater<Par>> fila;
-        fila.push({0, origem});
-
-        while (!fila.empty())
+        std::vector<char> usada(distancias.qtdChaves(), 0);
+        usada[distancias.chave(deposito)] = 1;
+        std::vector<int> candidatos(qtdServicos()), colunaInicio(qtdServicos() + 1);
+        for (int id = 1; id <= qtdServicos(); ++id)
         {
-            auto [custo, u] = fila.top();
-            fila.pop();
-            if (custo > dist[u])
-                continue;
-            for (auto &[v, w] : grafo[u])
-            {
-                if (dist[u] + w < dist[v])
-                {
-                    dist[v] = dist[u] + w;
-                    fila.push({dist[v], v});
-                }
-            }
+            candidatos[id - 1] = id;
+            colunaInicio[id] = distancias.chave(origemServico[id]);
+            usada[distancias.chave(destinoServico[id])] = 1;
         }
+        vizinhos.construir(
+            usada, candidatos, K_VIZINHOS, [&](int k, int id)
+            { return distancias[k][colunaInicio[id]]; },
+            pool);
     }
 
-    int custoTotal(const std::vector<Rota> &rotas)
+    // Custo dos serviços mais os deslocamentos entre eles (e de/para o depósito)
+    long long custoComDeslocamentos(const std::vector<Rota> &rotas) const
     {
-        int custo = 0;
+        long long custo = 0;
         for (const auto &rota : rotas)
+        {
+            int atual = deposito;
             for (auto &[tipo, id, u, v, c] : rota)
                 if (tipo == 1)
-                    custo += mapaCusto[id];
+                {
+                    custo += distancias.entre(atual, u) + (long long)mapaCusto[id];
+                    atual = v;
+                }
+            custo += distancias.entre(atual, deposito);
+        }
         return custo;
     }
 
-public:
-    void lerArquivo(const std::string &caminho)
+    // O custo de um serviço sobre a ligação alterada acompanha o novo custo
+    void atualizarCustoServicos(int origem, int destino, bool arco, int novoCusto)
     {
-        std::ifstream arquivo(caminho);
-        std::string linha;
-        int id_servico = 1;
+        for (auto &s : arco ? arcosRequeridos : arestasRequeridas)
+            if ((s.origem == origem && s.destino == destino) ||
+                (!arco && s.origem == destino && s.destino == origem))
+            {
+                s.custo = novoCusto;
+                mapaCusto[s.id] = novoCusto;
+            }
+    }
 
+    void carregarDados(const DadosInstancia &dados, const std::string &caminho)
+    {
         nomeBase = std::filesystem::path(caminho).stem().string();
+        int id_servico = 1;
         nosRequeridos.clear();
         arestasRequeridas.clear();
         arcosRequeridos.clear();
         mapaDemanda.clear();
         mapaCusto.clear();
 
-        while (std::getline(arquivo, linha))
+        capacidadeVeiculo = dados.capacidade;
+        deposito = dados.deposito;
+        qtdVertices = dados.qtdVertices;
+
+        nosRequeridos.reserve(dados.nosRequeridos.size());
+        for (const auto &n : dados.nosRequeridos)
+            nosRequeridos.push_back({n.vertice, n.demanda, n.custoServico, id_servico++, false});
+
+        arestasRequeridas.reserve(dados.arestasRequeridas.size());
+        for (const auto &e : dados.arestasRequeridas)
+            arestasRequeridas.push_back({id_servico++, e.origem, e.destino, e.custo, e.demanda});
+
+        arcosRequeridos.reserve(dados.arcosRequeridos.size());
+        for (const auto &a : dados.arcosRequeridos)
+            arcosRequeridos.push_back({id_servico++, a.origem, a.destino, a.custo, a.demanda});
+
+        construirMapas();
+    }
+
+    // Só as distâncias entre vértices-chave são guardadas; as linhas são
+    // calculadas em paralelo (Dijkstra por chave ou Floyd-Warshall, se denso)
+    void calcularDistancias(PoolThreads &pool)
+    {
+        calcularChaves(grafo, INF, distancias, pool);
+    }
+
+public:
+    // Renumera os vértices em ordem RCM a partir do depósito ao carregar a instância
+    void ativarReordenacao() { reordenar = true; }
+
+    // Prazo e quantidade de variantes aleatorizadas de construirRotas
+    void definirPortfolio(const ConfiguracaoPortfolio &config) { portfolio = config; }
+
+    bool lerArquivo(const std::string &caminho)
+    {
+        DadosInstancia dados;
+        if (!lerInstancia(caminho, dados))
         {
-            if (linha.rfind("Capacity:", 0) == 0)
-                capacidadeVeiculo = std::stoi(linha.substr(9));
-            else if (linha.rfind("Depot Node:", 0) == 0)
-                deposito = std::stoi(linha.substr(12));
-            else if (linha.rfind("#Nodes:", 0) == 0)
-            {
-                qtdVertices = std::stoi(linha.substr(8));
-                grafo.assign(qtdVertices + 1, {});
-            }
-            else if (linha.rfind("ReN.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'N')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    int demanda, custo;
-                    ss >> id >> demanda >> custo;
-                    int no = std::stoi(id.substr(1));
-                    nosRequeridos.push_back({no, demanda, custo, id_servico++, false});
-                }
-            }
-            else if (linha.rfind("ReE.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'E')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    int u, v, custo, demanda, scusto;
-                    ss >> id >> u >> v >> custo >> demanda >> scusto;
-                    arestasRequeridas.push_back({id_servico++, u, v, custo, demanda});
-                    grafo[u].emplace_back(v, custo);
-                    grafo[v].emplace_back(u, custo);
-                }
-            }
-            else if (linha.rfind("ReA.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'A')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    int u, v, custo, demanda, scusto;
-                    ss >> id >> u >> v >> custo >> demanda >> scusto;
-                    arcosRequeridos.push_back({id_servico++, u, v, custo, demanda});
-                    grafo[u].emplace_back(v, custo);
-                }
-            }
-            else if (linha.rfind("EDGE.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'E')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    int u, v, custo, dummy1, dummy2;
-                    ss >> id >> u >> v >> custo >> dummy1 >> dummy2;
-                    grafo[u].emplace_back(v, custo);
-                    grafo[v].emplace_back(u, custo);
-                }
-            }
-            else if (linha.rfind("ARC.", 0) == 0)
+            reportarErrosLeitura(std::cerr, caminho, dados);
+            return false;
+        }
+
+        if (reordenar)
+            reordenacao = reordenarInstancia(dados);
+        carregarDados(dados, caminho);
+        grafo = construirCSR(dados);
+        distancias.definir(qtdVertices, verticesChave(dados));
+        return true;
+    }
+
+    // Calcula as distâncias entre os vértices-chave, a menos que já venham de um snapshot
+    void preprocessar(PoolThreads &pool)
+    {
+        if (!distancias.calculado())
+            calcularDistancias(pool);
+        construirIndiceVizinhos(&pool);
+    }
+
+    std::size_t memoriaEstimada() const
+    {
+        std::size_t n = qtdVertices + 1, k = distancias.qtdChaves();
+        // + componente por vértice e DAG da condensação (no máximo uma ligação por entrada do CSR)
+        return k * k * sizeof(int) + 3 * n * sizeof(int) + grafo.destino.size() * (3 * sizeof(int) + 1);
+    }
+
+    // Lê o .dat, calcula as distâncias entre chaves e grava o snapshot binário em destino
+    bool compilarSnapshot(const std::string &caminho, const std::string &destino, PoolThreads &pool)
+    {
+        DadosInstancia dados;
+        if (!lerInstancia(caminho, dados))
+        {
+            reportarErrosLeitura(std::cerr, caminho, dados);
+            return false;
+        }
+
+        if (reordenar)
+            reordenacao = reordenarInstancia(dados);
+        carregarDados(dados, caminho);
+        grafo = construirCSR(dados);
+        distancias.definir(qtdVertices, verticesChave(dados));
+        calcularDistancias(pool);
+        return salvarSnapshot(destino, dados, grafo, distancias, reordenacao.original);
+    }
+
+    // Carrega um snapshot compilado; a tabela de distâncias é usada direto do mmap
+    bool carregarSnapshot(const std::string &caminho)
+    {
+        std::string erro;
+        if (!snapshot.abrir(caminho, erro))
+        {
+            std::cerr << caminho << ": " << erro << "\n";
+            return false;
+        }
+        // Ids de vértice e tabela seguem a numeração da compilação; com o modo
+        // pedido diferente o snapshot não serve e a instância vem do .dat
+        if (snapshot.reordenado() != reordenar)
+        {
+            std::cerr << caminho << ": snapshot compilado " << (snapshot.reordenado() ? "com" : "sem")
+                      << " --reordenar, lendo o .dat\n";
+            return false;
+        }
+
+        carregarDados(snapshot.dados(), caminho);
+        grafo = snapshot.grafo();
+        reordenacao = Reordenacao::aPartirDoOriginal(snapshot.permutacao());
+        if (!snapshot.apontarOraculo(distancias))
+        {
+            std::cerr << caminho << ": vertices-chave do snapshot invalidos\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Rejeita a instância antes de resolver quando algum serviço não pode ser
+    // atendido: demanda maior que a capacidade ou vértice-chave fora da
+    // componente forte do depósito (comum/condensacao.hpp). Depois dela todo
+    // par de vértices-chave é mutuamente alcançável e nenhuma consulta de
+    // distância do resolvedor devolve infinito.
+    bool verificarViabilidade(std::ostream &erro)
+    {
+        for (int id = 1; id <= qtdServicos(); ++id)
+            if (mapaDemanda[id] > capacidadeVeiculo)
             {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'A')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    int u, v, custo, dummy1, dummy2;
-                    ss >> id >> u >> v >> custo >> dummy1 >> dummy2;
-                    grafo[u].emplace_back(v, custo);
-                }
+                erro << nomeBase << ": instancia inviavel, servico " << id << " tem demanda maior que a capacidade\n";
+                return false;
             }
+        condensacao = Condensacao(grafo);
+        int v = verticeInviavel(condensacao, deposito, distancias.vertices());
+        if (v != 0)
+        {
+            erro << nomeBase << ": instancia inviavel, vertice " << reordenacao.paraOriginal(v)
+                 << (condensacao.alcanca(v, deposito) ? " nao e alcancado pelo deposito\n" : " nao alcanca o deposito\n");
+            return false;
         }
+        return true;
+    }
 
-        construirMapas();
-        distancias.assign(qtdVertices + 1, std::vector<int>(qtdVertices + 1, INF));
-        for (int i = 1; i <= qtdVertices; i++)
-            dijkstra(i, distancias[i]);
+    // Altera o custo de uma ligação (ids de vértice do arquivo) e conserta a
+    // tabela de distâncias de forma incremental. As linhas que dependem de
+    // aumentos só são recalculadas em reavaliar(). Devolve false se a ligação
+    // não existir.
+    bool alterarCustoLigacao(int origem, int destino, bool arco, int novoCusto)
+    {
+        origem = reordenacao.paraNovo(origem);
+        destino = reordenacao.paraNovo(destino);
+        if (origem < 1 || origem > qtdVertices || destino < 1 || destino > qtdVertices)
+            return false;
+        if (!atualizador)
+            atualizador = std::make_unique<AtualizadorDistancias>(grafo, distancias, INF);
+        if (!atualizador->alterarCusto(origem, destino, arco, novoCusto, linhasPendentes))
+            return false;
+        vizinhos.limpar();
+        atualizarCustoServicos(origem, destino, arco, novoCusto);
+        return true;
     }
 
-    void construirRotas()
+    // Recalcula as linhas pendentes e devolve o custo da solução atual
+    // (serviços + deslocamentos) com as distâncias atualizadas
+    long long reavaliar(PoolThreads &pool)
     {
-        std::map<int, std::tuple<int, int, int, int, int>> todosServicos;
-        for (auto &n : nosRequeridos)
-            todosServicos[n.servico_id] = std::make_tuple(1, n.servico_id, n.id, n.id, n.custo);
-        for (auto &e : arestasRequeridas)
-            todosServicos[e.id] = std::make_tuple(1, e.id, e.origem, e.destino, e.custo);
-        for (auto &a : arcosRequeridos)
-            todosServicos[a.id] = std::make_tuple(1, a.id, a.origem, a.destino, a.custo);
+        if (atualizador && !linhasPendentes.empty())
+        {
+            atualizador->recalcularLinhas(linhasPendentes, pool);
+            linhasPendentes.clear();
+        }
+        return custoComDeslocamentos(melhorSolucao);
+    }
 
-        melhorSolucao.clear();
-        int menorCusto = INF;
+    // Aplica as alterações do arquivo sobre a solução já construída e informa
+    // o custo antes e depois, sem reconstruir as rotas
+    bool aplicarAlteracoes(const std::string &caminho, PoolThreads &pool, std::ostream &log)
+    {
+        std::vector<AlteracaoCusto> alteracoes;
+        std::string erro;
+        if (!lerAlteracoes(caminho, alteracoes, erro))
+        {
+            log << erro << "\n";
+            return false;
+        }
+
+        long long antes = custoComDeslocamentos(melhorSolucao);
+        auto ini = std::chrono::high_resolution_clock::now();
+        int aplicadas = 0;
+        for (const auto &a : alteracoes)
+        {
+            if (alterarCustoLigacao(a.origem, a.destino, a.arco, a.custo))
+                ++aplicadas;
+            else
+                log << caminho << ": ligacao " << a.origem << " -> " << a.destino << " inexistente\n";
+        }
+        std::size_t recalculadas = linhasPendentes.size();
+        long long depois = reavaliar(pool);
+        auto fim = std::chrono::high_resolution_clock::now();
+
+        log << nomeBase << ": " << aplicadas << " alteracoes, " << recalculadas << "/" << distancias.qtdChaves()
+            << " linhas recalculadas, custo com deslocamentos " << antes << " -> " << depois << " ("
+            << std::chrono::duration_cast<std::chrono::microseconds>(fim - ini).count() / 1000.0 << " ms)\n";
+        return true;
+    }
+
+    double razaoCustoDemanda(int id) const
+    {
+        return mapaDemanda[id] > 0 ? (double)mapaCusto[id] / mapaDemanda[id] : std::numeric_limits<double>::infinity();
+    }
 
-        for (int regra = 1; regra <= 3; regra++)
+    // Dados somente leitura compartilhados pelas variantes do portfólio
+    struct DadosConstrucao
+    {
+        std::vector<int> colunaInicio;  // chave do início de cada serviço
+        std::vector<int> voltaDeposito; // distância do fim de cada serviço ao depósito
+        std::vector<int> porId, porDemanda, porRazao;
+        double demandaMedia = 0, custoMedio = 0;
+        std::vector<ServicoTour> servicosTour; // arestas requeridas reversíveis
+    };
+
+    DadosConstrucao prepararConstrucao() const
+    {
+        int total = qtdServicos();
+        DadosConstrucao dc;
+        dc.colunaInicio.assign(total + 1, 0);
+        dc.voltaDeposito.assign(total + 1, 0);
+        dc.porId.resize(total);
+        int chaveDeposito = distancias.chave(deposito);
+        for (int id = 1; id <= total; ++id)
         {
-            resetarServicos();
-            std::set<int> pendentes;
-            for (auto &[id, _] : todosServicos)
-                pendentes.insert(id);
-            std::vector<Rota> rotas;
+            dc.porId[id - 1] = id;
+            dc.colunaInicio[id] = distancias.chave(origemServico[id]);
+            dc.voltaDeposito[id] = distancias[distancias.chave(destinoServico[id])][chaveDeposito];
+            dc.demandaMedia += mapaDemanda[id];
+            dc.custoMedio += mapaCusto[id];
+        }
+        if (total > 0)
+        {
+            dc.demandaMedia /= total;
+            dc.custoMedio /= total;
+        }
+
+        // Ordens das regras de ordem fixa (demanda decrescente; custo/demanda
+        // crescente, demanda zero por último)
+        dc.porDemanda = dc.porRazao = dc.porId;
+        std::stable_sort(dc.porDemanda.begin(), dc.porDemanda.end(), [&](int a, int b)
+                         { return mapaDemanda[a] > mapaDemanda[b]; });
+        std::stable_sort(dc.porRazao.begin(), dc.porRazao.end(), [&](int a, int b)
+                         { return razaoCustoDemanda(a) < razaoCustoDemanda(b); });
 
-            while (!pendentes.empty())
+        dc.servicosTour.reserve(total);
+        for (const auto &no : nosRequeridos)
+            dc.servicosTour.push_back({no.servico_id, no.id, no.id, mapaCusto[no.servico_id], no.demanda, false});
+        for (const auto &e : arestasRequeridas)
+            dc.servicosTour.push_back({e.id, e.origem, e.destino, mapaCusto[e.id], e.demanda, true});
+        for (const auto &a : arcosRequeridos)
+            dc.servicosTour.push_back({a.id, a.origem, a.destino, mapaCusto[a.id], a.demanda, false});
+        return dc;
+    }
+
+    // Uma passada de path-scanning com a variante dada. Os serviços pendentes
+    // formam listas duplamente ligadas sobre vetores densos. Nas regras por
+    // proximidade a escolha é o mínimo de (distância, -desempate, id) entre os
+    // pendentes que cabem: a lista de vizinhos da posição atual já está em
+    // ordem de (distância, id), então basta percorrê-la até a distância
+    // passar da melhor encontrada, e os pendentes só são varridos quando a
+    // lista acaba antes disso. Nas regras de ordem fixa um cursor avança pela
+    // ordem ao longo da rota (quem não coube antes não cabe depois, porque a
+    // capacidade só diminui). Só usa buffers locais: as variantes rodam em
+    // paralelo.
+    std::vector<Rota> pathScanning(const VarianteRegra &variante, const DadosConstrucao &dc) const
+    {
+        int total = qtdServicos();
+        RegraEscolha regra = variante.regra;
+        bool ordemFixa = regra == RegraEscolha::OrdemDemanda || regra == RegraEscolha::OrdemCustoDemanda;
+        std::mt19937 rng(variante.semente);
+
+        // Listas ligadas sobre os ids (0 = fim); pendentes por id e pela ordem da regra
+        std::vector<int> proxId(total + 2), antId(total + 2), proxOrdem(total + 2), antOrdem(total + 2);
+        auto ligar = [&](const std::vector<int> &ordem, std::vector<int> &prox, std::vector<int> &ant)
+        {
+            int anterior = 0;
+            prox[0] = ordem.empty() ? 0 : ordem[0];
+            for (int id : ordem)
             {
-                int capacidadeRestante = capacidadeVeiculo;
-                Rota rota;
-                int atual = deposito;
-                rota.emplace_back(0, 0, 0, 0, 0);
+                ant[id] = anterior;
+                prox[anterior] = id;
+                anterior = id;
+            }
+            prox[anterior] = 0;
+            ant[0] = anterior;
+        };
+        auto desligar = [](int id, std::vector<int> &prox, std::vector<int> &ant)
+        {
+            prox[ant[id]] = prox[id];
+            ant[prox[id]] = ant[id];
+        };
+        std::vector<char> pendente(total + 1, 1);
+        ligar(dc.porId, proxId, antId);
+        if (ordemFixa)
+            ligar(regra == RegraEscolha::OrdemDemanda ? dc.porDemanda : dc.porRazao, proxOrdem, antOrdem);
+        int chaveDeposito = distancias.chave(deposito);
+
+        int restantes = total;
+        std::vector<Rota> rotas;
+        while (restantes > 0)
+        {
+            int capacidadeRestante = capacidadeVeiculo;
+            Rota rota;
+            int atual = deposito;
+            int cursor = proxOrdem[0];
+            rota.emplace_back(0, 0, 0, 0, 0);
 
-                while (true)
+            while (true)
+            {
+                int melhor = -1;
+                if (ordemFixa)
                 {
-                    int melhor = -1;
-                    double prioridade = INF;
-
-                    for (int id : pendentes)
+                    while (cursor != 0 && mapaDemanda[cursor] > capacidadeRestante)
+                        cursor = proxOrdem[cursor];
+                    if (cursor != 0)
+                    {
+                        melhor = cursor;
+                        cursor = proxOrdem[cursor];
+                        desligar(melhor, proxOrdem, antOrdem);
+                    }
+                }
+                else
+                {
+                    int k = distancias.chave(atual);
+                    const int *linha = distancias[k];
+                    int carga = capacidadeVeiculo - capacidadeRestante;
+                    // Elipse: perto do fim da carga, só serviços cujo desvio
+                    // (ir, atender e voltar ao depósito) não passa do custo
+                    // médio de um serviço além da volta direta
+                    bool elipse = variante.elipse && rota.size() > 1 &&
+                                  capacidadeRestante <= FATOR_ELIPSE * dc.demandaMedia;
+                    double limite = dc.custoMedio + linha[chaveDeposito];
+                    auto aceita = [&](int id, int d)
+                    {
+                        return mapaDemanda[id] <= capacidadeRestante &&
+                               (!elipse || (double)d + mapaCusto[id] + dc.voltaDeposito[id] <= limite);
+                    };
+                    auto desempate = [&](int id) -> double
+                    {
+                        switch (regra)
+                        {
+                        case RegraEscolha::LongeDeposito:
+                            return dc.voltaDeposito[id];
+                        case RegraEscolha::PertoDeposito:
+                            return -dc.voltaDeposito[id];
+                        case RegraEscolha::MaiorCustoDemanda:
+                            return razaoCustoDemanda(id);
+                        case RegraEscolha::MenorCustoDemanda:
+                            return -razaoCustoDemanda(id);
+                        case RegraEscolha::DependeCarga:
+                            return 2 * carga < capacidadeVeiculo ? dc.voltaDeposito[id] : -dc.voltaDeposito[id];
+                        case RegraEscolha::Aleatorio:
+                            return (double)rng();
+                        default:
+                            return 0;
+                        }
+                    };
+                    int distMelhor = INF;
+                    double valorMelhor = 0;
+                    auto considerar = [&](int id, int d)
                     {
-                        int u = atual;
-                        int v = std::get<2>(todosServicos[id]);
-                        int d = mapaDemanda[id];
-                        int c = mapaCusto[id];
-                        if (d > capacidadeRestante)
-                            continue;
-
-                        double crit;
-                        if (regra == 1)
-                            crit = distancias[u][v];
-                        else if (regra == 2)
-                            crit = -d;
-                        else
-                            crit = (double)c / d;
-
-                        if (crit < prioridade)
+                        if ((melhor != -1 && d > distMelhor) || !aceita(id, d))
+                            return;
+                        double valor = desempate(id);
+                        if (melhor == -1 || d < distMelhor || valor > valorMelhor)
                         {
-                            prioridade = crit;
                             melhor = id;
+                            distMelhor = d;
+                            valorMelhor = valor;
                         }
-                    }
-
-                    if (melhor == -1)
-                        break;
+                    };
 
-                    capacidadeRestante -= mapaDemanda[melhor];
-                    rota.push_back(todosServicos[melhor]);
-                    pendentes.erase(melhor);
-                    atual = std::get<3>(todosServicos[melhor]);
+                    const int *it = vizinhos.inicio(k), *fim = vizinhos.fim(k);
+                    for (; it != fim; ++it)
+                    {
+                        int d = linha[dc.colunaInicio[*it]];
+                        if (melhor != -1 && (d > distMelhor || regra == RegraEscolha::MaisProximo))
+                            break;
+                        if (pendente[*it])
+                            considerar(*it, d);
+                    }
+                    // A lista decide se parou numa distância maior que a da
+                    // escolha, se cobre todos os serviços ou, na regra
+                    // MaisProximo, se achou algum (o primeiro já tem o menor id)
+                    bool decidido = melhor != -1 && (it != fim || fim - vizinhos.inicio(k) == total ||
+                                                     regra == RegraEscolha::MaisProximo);
+                    if (!decidido)
+                    {
+                        melhor = -1;
+                        for (int id = proxId[0]; id != 0; id = proxId[id])
+                            considerar(id, linha[dc.colunaInicio[id]]);
+                    }
                 }
 
-                rota.emplace_back(0, 0, 0, 0, 0);
-                if (rota.size() > 2)
-                    rotas.push_back(rota);
-                else
+                if (melhor == -1)
                     break;
+
+                capacidadeRestante -= mapaDemanda[melhor];
+                rota.emplace_back(1, melhor, origemServico[melhor], destinoServico[melhor], mapaCusto[melhor]);
+                pendente[melhor] = 0;
+                desligar(melhor, proxId, antId);
+                restantes--;
+                atual = destinoServico[melhor];
             }
 
-            int custoAtual = custoTotal(rotas);
-            if (custoAtual < menorCusto)
+            rota.emplace_back(0, 0, 0, 0, 0);
+            if (rota.size() > 2)
+                rotas.push_back(rota);
+            else
+                break;
+        }
+        return rotas;
+    }
+
+    // Tour gigante + Split: as viagens já saem com a orientação de cada aresta
+    std::vector<Rota> construirPorTourGigante(const VarianteRegra &variante, const DadosConstrucao &dc) const
+    {
+        std::mt19937 rng(variante.semente);
+        auto viagens = construirPorSplit(
+            dc.servicosTour, capacidadeVeiculo, deposito, [&](int u, int v)
+            { return distancias.entre(u, v); },
+            variante.semente ? &rng : nullptr);
+
+        std::vector<Rota> rotas;
+        rotas.reserve(viagens.size());
+        for (const auto &viagem : viagens)
+        {
+            Rota rota;
+            rota.emplace_back(0, 0, 0, 0, 0);
+            for (const auto &passo : viagem)
             {
-                menorCusto = custoAtual;
-                melhorSolucao = rotas;
+                const ServicoTour &s = dc.servicosTour[passo.servico];
+                rota.emplace_back(1, s.id, entradaDe(s, passo.invertido), saidaDe(s, passo.invertido), s.custo);
             }
+            rota.emplace_back(0, 0, 0, 0, 0);
+            rotas.push_back(std::move(rota));
+        }
+        return rotas;
+    }
+
+    // Portfólio de path-scanning (comum/portfolio.hpp): cada variante é uma
+    // tarefa do pool. As regras fixas sempre rodam; as variantes sorteadas
+    // (sementes 1, 2, ...: desempate aleatório sem e com a regra da elipse e
+    // tour gigante aleatorizado, em rodízio) começam enquanto o prazo não
+    // venceu. Fica a solução de menor custo com
+    // deslocamentos, com empate para a variante que vem antes.
+    void construirRotas(PoolThreads &pool)
+    {
+        if (vizinhos.vazio())
+            construirIndiceVizinhos(&pool);
+        resetarServicos();
+        DadosConstrucao dc = prepararConstrucao();
+
+        std::vector<VarianteRegra> variantes = REGRAS_FIXAS;
+        for (int i = 0; i < portfolio.variantesAleatorias; ++i)
+            variantes.push_back({i % 3 == 2 ? RegraEscolha::TourGigante : RegraEscolha::Aleatorio, i % 3 == 1,
+                                 (unsigned)i + 1});
+        std::vector<std::vector<Rota>> solucoes(variantes.size());
+        int melhor = executarPortfolio(pool, (int)REGRAS_FIXAS.size(), (int)variantes.size(), portfolio.tempoMaximo,
+                                       [&](int i, int)
+                                       {
+                                           solucoes[i] = variantes[i].regra == RegraEscolha::TourGigante
+                                                             ? construirPorTourGigante(variantes[i], dc)
+                                                             : pathScanning(variantes[i], dc);
+                                           return custoComDeslocamentos(solucoes[i]);
+                                       });
+
+        melhorSolucao.clear();
+        if (melhor != -1)
+            melhorSolucao = std::move(solucoes[melhor]);
+    }
+
+    // Grava em caminhos-<instancia>.dat a sequência completa de vértices de cada
+    // rota: depósito, deslocamentos expandidos, serviços e volta ao depósito
+    void salvarCaminhos()
+    {
+        std::ofstream out("caminhos-" + nomeBase + ".dat");
+        ExpansorCaminhos expansor(grafo);
+        std::vector<int> caminho;
+        int rota_id = 1;
+        for (const auto &rota : melhorSolucao)
+        {
+            caminho.assign(1, deposito);
+            for (auto &[tipo, id, u, v, c] : rota)
+                if (tipo == 1)
+                {
+                    expansor.expandir(caminho.back(), u, caminho);
+                    if (v != u)
+                        caminho.push_back(v);
+                }
+            expansor.expandir(caminho.back(), deposito, caminho);
+
+            out << rota_id++ << " " << caminho.size();
+            for (int x : caminho)
+                out << " " << reordenacao.paraOriginal(x);
+            out << "\n";
         }
     }
 
-    void salvarSolucao(long long clocks)
+    // Com comCaminhos, grava também os caminhos percorridos (salvarCaminhos)
+    void salvarSolucao(long long clocks, bool comCaminhos = false)
     {
         std::string nomeArquivo = "sol-" + nomeBase + ".dat";
         std::ofstream out(nomeArquivo);
@@ -328,31 +755,151 @@ public:
                 if (tipo == 0)
                     out << " (D " << u << ",1,1)";
                 else
-                    out << " (S " << id << "," << u << "," << v << ")";
+                    out << " (S " << id << "," << reordenacao.paraOriginal(u) << "," << reordenacao.paraOriginal(v) << ")";
             }
             out << "\n";
         }
         out.close();
+
+        if (comCaminhos)
+            salvarCaminhos();
     }
 };
 
-int main()
+struct ItemSolucao
+{
+    Instancia instancia;
+    long long tempo = 0;
+    std::string alteracoes; // arquivo <instancia>.alt, se existir
+};
+
+int main(int argc, char *argv[])
 {
     std::string pasta = "dados/";
-    for (const auto &entrada : std::filesystem::directory_iterator(pasta))
+    bool compilar = false;
+    bool reordenar = false;
+    bool caminhos = false;
+    ConfiguracaoPipeline config;
+    ConfiguracaoPortfolio configPortfolio;
+    for (int i = 1; i < argc; ++i)
     {
+        std::string arg = argv[i];
+        if (arg == "--compilar")
+            compilar = true;
+        else if (arg == "--reordenar")
+            reordenar = true;
+        else if (arg == "--caminhos")
+            caminhos = true;
+        else if (arg == "--tempo" || arg == "--variantes")
+        {
+            double tempo = 0;
+            long variantes = 0;
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Falta o valor de " << arg << "\n";
+                return 1;
+            }
+            if (arg == "--tempo" ? !lerReal(argv[i + 1], tempo) : !lerInteiro(argv[i + 1], variantes))
+            {
+                std::cerr << "Valor invalido para " << arg << ": " << argv[i + 1] << "\n";
+                return 1;
+            }
+            ++i;
+            if (arg == "--tempo")
+                configPortfolio.tempoMaximo = std::max(0.0, tempo);
+            else
+                configPortfolio.variantesAleatorias = (int)std::min<long>(std::max(0L, variantes), INT_MAX);
+        }
+        else
+        {
+            ResultadoOpcao resultado = lerOpcaoPipeline(argc, argv, i, config);
+            if (resultado == ResultadoOpcao::Desconhecida)
+                std::cerr << "Opcao desconhecida: " << arg << "\n";
+            if (resultado != ResultadoOpcao::Aceita)
+                return 1;
+        }
+    }
+
+    std::vector<std::string> entradas;
+    for (const auto &entrada : std::filesystem::directory_iterator(pasta))
         if (entrada.path().extension() == ".dat")
+            entradas.push_back(entrada.path().string());
+
+    if (compilar)
+    {
+        PoolThreads pool;
+        for (const auto &caminho : entradas)
         {
-            std::cout << "Processando: " << entrada.path().filename() << std::endl;
+            std::cout << "Compilando: " << std::filesystem::path(caminho).filename() << std::endl;
+            auto caminhoSnapshot = std::filesystem::path(caminho).replace_extension(".snap");
             Instancia instancia;
-            instancia.lerArquivo(entrada.path().string());
-            auto ini = std::chrono::high_resolution_clock::now();
-            instancia.construirRotas();
-            auto fim = std::chrono::high_resolution_clock::now();
-            long long tempo = std::chrono::duration_cast<std::chrono::nanoseconds>(fim - ini).count();
-            instancia.salvarSolucao(tempo);
+            if (reordenar)
+                instancia.ativarReordenacao();
+            if (!instancia.compilarSnapshot(caminho, caminhoSnapshot.string(), pool))
+                std::cerr << "Falha ao gravar " << caminhoSnapshot << std::endl;
         }
+        std::cout << "Snapshots gerados com Sucesso!!!\n";
+        return 0;
     }
+
+    std::mutex mtxSaida;
+    EtapasPipeline<ItemSolucao> etapas;
+    etapas.ler = [&](const std::string &caminho) -> std::unique_ptr<ItemSolucao>
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtxSaida);
+            std::cout << "Processando: " << std::filesystem::path(caminho).filename() << std::endl;
+        }
+        auto item = std::make_unique<ItemSolucao>();
+        if (reordenar)
+            item->instancia.ativarReordenacao();
+        item->instancia.definirPortfolio(configPortfolio);
+        auto caminhoSnapshot = std::filesystem::path(caminho).replace_extension(".snap");
+        bool carregado = false;
+        std::error_code ec;
+        if (std::filesystem::exists(caminhoSnapshot, ec) &&
+            std::filesystem::last_write_time(caminhoSnapshot, ec) >= std::filesystem::last_write_time(caminho, ec))
+            carregado = item->instancia.carregarSnapshot(caminhoSnapshot.string());
+        if (!carregado && !item->instancia.lerArquivo(caminho))
+            return nullptr;
+        {
+            std::ostringstream erro;
+            if (!item->instancia.verificarViabilidade(erro))
+            {
+                std::lock_guard<std::mutex> lock(mtxSaida);
+                std::cerr << erro.str();
+                return nullptr;
+            }
+        }
+        auto caminhoAlteracoes = std::filesystem::path(caminho).replace_extension(".alt");
+        if (std::filesystem::exists(caminhoAlteracoes, ec))
+            item->alteracoes = caminhoAlteracoes.string();
+        return item;
+    };
+    etapas.memoria = [](const ItemSolucao &item)
+    { return item.instancia.memoriaEstimada(); };
+    PoolsPipeline pools(entradas.size());
+    etapas.preprocessar = [&](ItemSolucao &item)
+    { item.instancia.preprocessar(pools.preparo()); };
+    etapas.resolver = [&](ItemSolucao &item)
+    {
+        auto ini = std::chrono::high_resolution_clock::now();
+        item.instancia.construirRotas(pools.resolucao());
+        auto fim = std::chrono::high_resolution_clock::now();
+        item.tempo = std::chrono::duration_cast<std::chrono::nanoseconds>(fim - ini).count();
+
+        if (!item.alteracoes.empty())
+        {
+            std::ostringstream log;
+            item.instancia.aplicarAlteracoes(item.alteracoes, pools.resolucao(), log);
+            std::lock_guard<std::mutex> lock(mtxSaida);
+            std::cout << log.str();
+        }
+    };
+    etapas.escrever = [&](ItemSolucao &item)
+    { item.instancia.salvarSolucao(item.tempo, caminhos); };
+
+    executarPipeline(entradas, config, etapas);
     std::cout << "Solucoes geradas com Sucesso!!!\n";
     return 0;
 }
@@ -1,6 +1,5 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <map>
 #include <queue>
@@ -9,6 +8,7 @@
 #include <chrono>
 #include <tuple>
 #include <limits>
+#include <climits>
 #include <algorithm>
 #include <random>
 #include <future>
@@ -19,61 +19,80 @@
 #include <atomic>
 #include <mutex>
 #include <filesystem>
+#include <sstream>
 #include <windows.h>
 
-const short INF = 32767;
+#include "comum/leitor_instancia.hpp"
+#include "comum/grafo_csr.hpp"
+#include "comum/pipeline.hpp"
+#include "comum/reordenacao.hpp"
+#include "comum/oraculo_chaves.hpp"
+#include "comum/apsp.hpp"
+#include "comum/expansor_caminhos.hpp"
+#include "comum/distancias_dinamicas.hpp"
+#include "comum/condensacao.hpp"
+#include "comum/split.hpp"
+#include "comum/rotas_compactas.hpp"
+#include "comum/indice_vizinhos.hpp"
+
+const int INF = INT_MAX / 2;
+// Tamanho das listas de serviços mais próximos usadas como candidatos pela busca local
+const int K_VIZINHOS = 16;
 
 struct Servico
 {
-    short id, origem, destino, custo, demanda;
+    int id, origem, destino, custo, demanda;
 };
 
 struct NoRequerido
 {
-    short id, demanda, custo, servico_id;
+    int id, demanda, custo, servico_id;
 };
 
 struct Aresta
 {
-    short u, v, peso;
+    int u, v, peso;
 };
 
-typedef std::pair<short, short> Par;
-typedef std::vector<std::vector<Par>> ListaAdj;
-using Rota = std::vector<std::tuple<short, short, short, short, short>>;
+typedef std::pair<int, int> Par;
 
 class Instancia
 {
 private:
-    short capacidadeVeiculo = 0, deposito = 0, qtdVertices = 0;
+    int capacidadeVeiculo = 0, deposito = 0, qtdVertices = 0;
     std::string nomeBase;
     std::vector<NoRequerido> nosRequeridos;
     std::vector<Servico> arestasRequeridas, arcosRequeridos;
 
-    std::vector<short> mapaDemanda, mapaCusto;
-    short maxServicoId = 0;
-
-    ListaAdj grafo;
-
-    // Cache de distâncias thread-safe
-    std::vector<std::vector<short>> distanciasCache;
-    std::vector<std::atomic<bool> *> distanciasCalculadas;
-    std::vector<std::unique_ptr<std::mutex>> distanciasMutex;
-
-    std::vector<Rota> melhorSolucao;
-    std::atomic<int> melhorCustoGlobal{32767};
+    // Atributos dos serviços por id (comum/rotas_compactas.hpp)
+    TabelaServicos tabela;
+    int maxServicoId = 0;
+
+    GrafoCSR grafo;
+    Condensacao condensacao;
+    Reordenacao reordenacao;
+    bool reordenar = false;
+    // Construtor do GRASP: tour gigante + Split (padrão) ou as construções gulosas
+    bool construcaoSplit = true;
+    std::vector<ServicoTour> servicosTour;
+    // Para cada serviço, os K_VIZINHOS serviços mais próximos em qualquer sentido
+    IndiceVizinhos vizinhos;
+
+    // Distâncias entre vértices-chave: a tabela inteira é calculada em paralelo
+    // em preprocessar() e fica congelada durante a busca; dist é a visão
+    // somente leitura consultada pelos operadores
+    OraculoChaves distancias;
+    OraculoChaves::Consulta consultaDistancias;
+    std::vector<int> linhasPendentes;
+
+    SolucaoRotas melhorSolucao;
+    std::atomic<long long> melhorCustoGlobal{LLONG_MAX};
     std::mutex melhorSolucaoMutex;
 
-public:
-    // Destrutor para liberar memória dos atomic<bool>*
-    ~Instancia()
-    {
-        for (auto *ptr : distanciasCalculadas)
-        {
-            delete ptr;
-        }
-    }
+    // Criado na primeira alteração de custo de uma ligação
+    std::unique_ptr<AtualizadorDistancias> atualizador;
 
+public:
     void construirMapas()
     {
         for (const auto &no : nosRequeridos)
@@ -83,288 +102,477 @@ public:
         for (const auto &a : arcosRequeridos)
             maxServicoId = std::max(maxServicoId, a.id);
 
-        mapaDemanda.assign(maxServicoId + 1, 0);
-        mapaCusto.assign(maxServicoId + 1, 0);
+        tabela.redimensionar(maxServicoId);
 
         for (const auto &no : nosRequeridos)
         {
-            mapaDemanda[no.servico_id] = no.demanda;
-            mapaCusto[no.servico_id] = no.custo;
-        }
-        for (const auto &e : arestasRequeridas)
-        {
-            mapaDemanda[e.id] = e.demanda;
-            mapaCusto[e.id] = e.custo;
-        }
-        for (const auto &a : arcosRequeridos)
-        {
-            mapaDemanda[a.id] = a.demanda;
-            mapaCusto[a.id] = a.custo;
+            tabela.inicio[no.servico_id] = tabela.fim[no.servico_id] = no.id;
+            tabela.demanda[no.servico_id] = no.demanda;
+            tabela.custo[no.servico_id] = no.custo;
         }
+        for (const auto *lista : {&arestasRequeridas, &arcosRequeridos})
+            for (const auto &s : *lista)
+            {
+                tabela.inicio[s.id] = s.origem;
+                tabela.fim[s.id] = s.destino;
+                tabela.demanda[s.id] = s.demanda;
+                tabela.custo[s.id] = s.custo;
+                tabela.reversivel[s.id] = lista == &arestasRequeridas;
+            }
     }
 
-    // Dijkstra thread-safe com double-checked locking
-    const std::vector<short> &obterDistancias(short origem)
+    // Linha da tabela congelada; origem deve ser vértice-chave
+    OraculoChaves::Linha obterDistancias(int origem) const
     {
-        if (!distanciasCalculadas[origem]->load(std::memory_order_acquire))
-        {
-            std::lock_guard<std::mutex> lock(*distanciasMutex[origem]);
-            if (!distanciasCalculadas[origem]->load(std::memory_order_relaxed))
-            {
-                dijkstra(origem, distanciasCache[origem]);
-                distanciasCalculadas[origem]->store(true, std::memory_order_release);
-            }
-        }
-        return distanciasCache[origem];
+        return distancias.linhaDe(origem);
     }
 
-    void dijkstra(short origem, std::vector<short> &dist)
+    // Distância entre vértices-chave no formato das rotinas genéricas
+    // (comum/split.hpp, comum/rotas_compactas.hpp)
+    OraculoChaves::Consulta funcaoDistancia() const { return consultaDistancias; }
+
+    // Custo dos serviços mais os deslocamentos entre eles (e de/para o depósito),
+    // recalculado com as distâncias atuais
+    long long custoComDeslocamentos(const SolucaoRotas &solucao)
     {
-        dist.assign(qtdVertices + 1, INF);
-        dist[origem] = 0;
-        std::priority_queue<Par, std::vector<Par>, std::greater<Par>> fila;
-        fila.push({0, origem});
+        long long custo = 0;
+        for (const auto &rota : solucao.passos)
+            custo += solucao.custoDe(rota, funcaoDistancia());
+        return custo;
+    }
 
-        while (!fila.empty())
+    // Menor deslocamento do fim de o ao início de c, em qualquer sentido
+    // permitido de cada um; é o critério das listas de vizinhos
+    int proximidade(int o, int c)
+    {
+        int menor = INF;
+        for (int so = 0; so < (tabela.reversivel[o] ? 2 : 1); ++so)
         {
-            auto [custo, u] = fila.top();
-            fila.pop();
-            if (custo > dist[u])
-                continue;
-            for (auto &[v, w] : grafo[u])
-            {
-                if (dist[u] + w < dist[v])
-                {
-                    dist[v] = dist[u] + w;
-                    fila.push({dist[v], v});
-                }
-            }
+            const auto &linha = obterDistancias(so ? tabela.inicio[o] : tabela.fim[o]);
+            menor = std::min(menor, linha[tabela.inicio[c]]);
+            if (tabela.reversivel[c])
+                menor = std::min(menor, linha[tabela.fim[c]]);
         }
+        return menor;
     }
 
-    int custoTotal(const std::vector<Rota> &rotas) const
+    void construirIndiceVizinhos(PoolThreads &pool)
     {
-        int custo = 0;
-        for (const auto &rota : rotas)
-            for (const auto &[tipo, id, u, v, c] : rota)
-                if (tipo == 1)
-                    custo += mapaCusto[id];
-        return custo;
+        std::vector<char> usada(maxServicoId + 1, 1);
+        usada[0] = 0;
+        std::vector<int> candidatos(maxServicoId);
+        for (int id = 1; id <= maxServicoId; ++id)
+            candidatos[id - 1] = id;
+        vizinhos.construir(
+            usada, candidatos, K_VIZINHOS + 1, [&](int o, int c)
+            { return proximidade(o, c); },
+            &pool);
+    }
+
+    // Passo percorrido ao contrário: arestas requeridas trocam de sentido;
+    // arcos e nós ficam como estão
+    int passoOposto(int passo) const
+    {
+        return tabela.reversivel[servicoDo(passo)] ? inverterPasso(passo) : passo;
     }
 
-    short calcularCargaRota(const Rota &rota) const
+    // Somas prefixas das ligações internas da rota r: F no sentido da rota e
+    // R com o trecho percorrido ao contrário (passoOposto). O custo interno
+    // das posições a..b é F[b] - F[a] e, invertido, R[b] - R[a]. Depois de um
+    // movimento que só alterou as posições desde em diante, as entradas
+    // anteriores continuam valendo e só o resto é refeito.
+    void calcularPrefixos(const SolucaoRotas &solucao, int r, std::vector<long long> &F, std::vector<long long> &R,
+                          int desde = 0)
     {
-        short carga = 0;
-        for (const auto &[tipo, id, u, v, c] : rota)
+        const std::vector<int> &rota = solucao.passos[r];
+        int n = (int)rota.size();
+        F.resize(n);
+        R.resize(n);
+        if (n == 0)
+            return;
+        auto dist = funcaoDistancia();
+        F[0] = R[0] = 0;
+        for (int t = std::max(desde, 1); t < n; ++t)
         {
-            if (tipo == 1)
-                carga += mapaDemanda[id];
+            F[t] = F[t - 1] + dist(solucao.saida(rota[t - 1]), solucao.entrada(rota[t]));
+            R[t] = R[t - 1] + dist(solucao.saida(passoOposto(rota[t])), solucao.entrada(passoOposto(rota[t - 1])));
         }
-        return carga;
     }
 
-    // 2-opt otimizado com parada antecipada - MELHORIA 2
-    bool aplicar2Opt(Rota &rota)
+    // 2-opt intra-rota com avaliação exata: inverter as posições a..b troca
+    // as duas ligações das pontas e percorre o trecho ao contrário, com cada
+    // aresta requerida atendida no outro sentido (arcos mantêm o sentido).
+    // Com as somas prefixas das ligações internas no sentido original (F) e
+    // no invertido (R), o delta de qualquer inversão sai em O(1), mesmo com
+    // distâncias assimétricas:
+    //   antes  = d(pre, ent(p[a])) + F[b] - F[a] + d(sai(p[b]), pos)
+    //   depois = d(pre, ent(p'[b])) + R[b] - R[a] + d(sai(p'[a]), pos)
+    // Os candidatos de cada serviço x na posição i são os vizinhos y da mesma
+    // rota (nova ligação x -> y invertendo i+1..pos(y), ou y -> x invertendo
+    // pos(y)..i-1), as inversões até as pontas da rota e a troca de sentido
+    // do próprio x. Bits "não olhar": só volta à fila quem teve uma ligação
+    // alterada, e a busca termina quando a fila esvazia (ótimo local). Cada
+    // inversão aplicada refaz as somas prefixas a partir de a, O(n - a). Fila
+    // e somas prefixas são buffers da thread, como no Or-opt.
+    bool aplicar2Opt(SolucaoRotas &solucao, int r)
     {
-        if (rota.size() <= 4)
+        std::vector<int> &rota = solucao.passos[r];
+        int n = (int)rota.size();
+        if (n < 2)
             return false;
 
-        bool melhorou = false;
-        for (size_t i = 1; i < rota.size() - 2; ++i)
+        auto dist = funcaoDistancia();
+        thread_local std::vector<long long> F, R;
+        auto delta = [&](int a, int b) -> long long
+        {
+            int pre = solucao.saidaEm(r, a - 1), pos = solucao.entradaEm(r, b + 1);
+            long long antes = dist(pre, solucao.entrada(rota[a])) + (F[b] - F[a]) + dist(solucao.saida(rota[b]), pos);
+            long long depois = dist(pre, solucao.entrada(passoOposto(rota[b]))) + (R[b] - R[a]) +
+                               dist(solucao.saida(passoOposto(rota[a])), pos);
+            return depois - antes;
+        };
+
+        // Fila de serviços a examinar; fila e naFila (indexado por id) são
+        // reaproveitados entre chamadas da mesma thread
+        thread_local std::vector<int> fila;
+        thread_local std::vector<char> naFila;
+        if ((int)naFila.size() < maxServicoId + 1)
+        {
+            naFila.assign(maxServicoId + 1, 0);
+            fila.reserve(maxServicoId + 1);
+        }
+        fila.clear();
+        for (int p = n - 1; p >= 0; --p)
+        {
+            fila.push_back(servicoDo(rota[p]));
+            naFila[fila.back()] = 1;
+        }
+        auto enfileirar = [&](int p)
         {
-            bool melhorouNivelI = false;
-            for (size_t j = i + 1; j < rota.size() - 1; ++j)
+            if (p < 0 || p >= n)
+                return;
+            int id = servicoDo(rota[p]);
+            if (!naFila[id])
             {
-                // Calcular custo atual das conexões que serão quebradas/criadas
-                auto &elem_i = rota[i];
-                auto &elem_i_next = rota[i + 1];
-                auto &elem_j = rota[j];
-                auto &elem_j_next = rota[j + 1];
-
-                // Estimativa simples de melhoria baseada em distâncias
-                short u1 = std::get<3>(elem_i), v1 = std::get<2>(elem_i_next);
-                short u2 = std::get<3>(elem_j), v2 = std::get<2>(elem_j_next);
-
-                const auto &dist_u1 = obterDistancias(u1);
-                const auto &dist_u2 = obterDistancias(u2);
-
-                short custoAtual = dist_u1[v1] + dist_u2[v2];
-                short novoCusto = dist_u1[u2] + dist_u2[v1];
+                naFila[id] = 1;
+                fila.push_back(id);
+            }
+        };
 
-                if (novoCusto < custoAtual - 5) // threshold mínimo
+        calcularPrefixos(solucao, r, F, R);
+        bool melhorou = false;
+        while (!fila.empty())
+        {
+            int x = fila.back();
+            fila.pop_back();
+            naFila[x] = 0;
+            int i = solucao.posicaoDe[x];
+
+            long long melhorDelta = 0;
+            int melhorA = -1, melhorB = -1;
+            auto avaliar = [&](int a, int b)
+            {
+                long long d = delta(a, b);
+                if (d < melhorDelta)
                 {
-                    std::reverse(rota.begin() + i + 1, rota.begin() + j + 1);
-                    melhorou = melhorouNivelI = true;
-                    break; // Para assim que encontrar melhoria significativa
+                    melhorDelta = d;
+                    melhorA = a;
+                    melhorB = b;
                 }
+            };
+            for (const int *it = vizinhos.inicio(x); it != vizinhos.fim(x); ++it)
+            {
+                int y = *it;
+                if (y == x || solucao.rotaDe[y] != r)
+                    continue;
+                int j = solucao.posicaoDe[y];
+                if (j > i)
+                    avaliar(i + 1, j);
+                else
+                    avaliar(j, i - 1);
             }
-            if (melhorouNivelI)
-                break; // Move para próximo i se melhorou
+            if (i > 0)
+                avaliar(0, i);
+            if (i < n - 1)
+                avaliar(i, n - 1);
+            if (tabela.reversivel[x])
+                avaliar(i, i);
+
+            if (melhorA == -1)
+                continue;
+            int a = melhorA, b = melhorB;
+            std::reverse(rota.begin() + a, rota.begin() + b + 1);
+            for (int p = a; p <= b; ++p)
+                rota[p] = passoOposto(rota[p]);
+            solucao.custo[r] += melhorDelta;
+            solucao.reindexar(r, a, b);
+            calcularPrefixos(solucao, r, F, R, a);
+            melhorou = true;
+            for (int p : {a - 1, a, b, b + 1})
+                enfileirar(p);
         }
         return melhorou;
     }
 
-    // Or-opt otimizado - move apenas segmentos que realmente melhoram
-    bool aplicarOrOpt(Rota &rota)
+    // Or-opt intra-rota: leva um trecho de 1 a 3 serviços consecutivos para
+    // outra posição da mesma rota, no sentido original ou invertido (com as
+    // arestas requeridas do trecho trocando de sentido). O delta é exato e sai
+    // das ligações que mudam mais a diferença de custo interno do trecho
+    // invertido (somas prefixas, como no 2-opt):
+    //   d(pre, pos) - d(pre, ent) - d(sai, pos) + d(u, ent') + d(sai', v) - d(u, v)
+    // Os pontos de inserção u -> v vêm das listas de vizinhos (o trecho logo
+    // depois de um vizinho da ponta que passa a abri-lo, ou logo antes de um
+    // vizinho da ponta que passa a fechá-lo) mais as duas pontas da rota. A rota só é alterada quando um movimento é
+    // aplicado (std::rotate no lugar). Fila com bits "não olhar" como no
+    // 2-opt: x é examinado como início de trecho e volta à fila quando uma
+    // ligação até 3 posições à frente muda. Fila e somas prefixas são buffers
+    // da thread, então depois do aquecimento o operador não aloca memória.
+    bool aplicarOrOpt(SolucaoRotas &solucao, int r)
     {
-        if (rota.size() <= 4)
+        std::vector<int> &rota = solucao.passos[r];
+        int n = (int)rota.size();
+        if (n < 2)
             return false;
 
-        // Testar segmentos de tamanho 1 e 2 (mais eficiente)
-        for (int segSize = 1; segSize <= std::min(2, (int)rota.size() - 3); ++segSize)
+        auto dist = funcaoDistancia();
+        thread_local std::vector<long long> F, R;
+        thread_local std::vector<int> fila;
+        thread_local std::vector<char> naFila;
+        if ((int)naFila.size() < maxServicoId + 1)
         {
-            for (size_t i = 1; i < rota.size() - segSize; ++i)
+            naFila.assign(maxServicoId + 1, 0);
+            fila.reserve(maxServicoId + 1);
+        }
+        fila.clear();
+        for (int p = n - 1; p >= 0; --p)
+        {
+            fila.push_back(servicoDo(rota[p]));
+            naFila[fila.back()] = 1;
+        }
+        // Trechos que começam até 3 posições antes da ligação (j-1, j)
+        auto enfileirarAntes = [&](int j)
+        {
+            for (int p = std::max(0, j - 3); p <= std::min(j, n - 1); ++p)
             {
-                // Calcular custo de remoção
-                short custoRemocao = 0;
-                if (i > 1 && i + segSize < rota.size() - 1)
+                int id = servicoDo(rota[p]);
+                if (!naFila[id])
                 {
-                    short u_antes = std::get<3>(rota[i - 1]);
-                    short v_depois = std::get<2>(rota[i + segSize]);
-                    custoRemocao = obterDistancias(u_antes)[v_depois];
+                    naFila[id] = 1;
+                    fila.push_back(id);
                 }
+            }
+        };
 
-                // Extrair segmento
-                std::vector<std::tuple<short, short, short, short, short>> segmento(
-                    rota.begin() + i, rota.begin() + i + segSize);
-                rota.erase(rota.begin() + i, rota.begin() + i + segSize);
-
-                bool melhorou = false;
-                size_t melhorPos = i;
-                short melhorGanho = 0;
-
-                // Testar posições próximas primeiro (mais provável de melhorar)
-                std::vector<size_t> posicoes;
-                for (size_t pos = 1; pos < rota.size(); ++pos)
-                    posicoes.push_back(pos);
-
-                // Ordenar por distância da posição original
-                std::sort(posicoes.begin(), posicoes.end(),
-                          [i](size_t a, size_t b)
-                          { return abs((int)a - (int)i) < abs((int)b - (int)i); });
-
-                for (size_t pos : posicoes)
+        calcularPrefixos(solucao, r, F, R);
+        bool melhorou = false;
+        while (!fila.empty())
+        {
+            int x = fila.back();
+            fila.pop_back();
+            naFila[x] = 0;
+            int i = solucao.posicaoDe[x];
+
+            long long melhorDelta = 0;
+            int melhorLacuna = -1, melhorTamanho = 0;
+            bool melhorInvertido = false;
+            for (int tamanho = 1; tamanho <= 3 && i + tamanho <= n; ++tamanho)
+            {
+                int primeiro = rota[i], ultimo = rota[i + tamanho - 1];
+                int pre = solucao.saidaEm(r, i - 1), pos = solucao.entradaEm(r, i + tamanho);
+                long long remocao = dist(pre, pos) - dist(pre, solucao.entrada(primeiro)) -
+                                    dist(solucao.saida(ultimo), pos);
+                bool podeInverter = tamanho > 1 || tabela.reversivel[x];
+                int entradaInvertida = solucao.entrada(passoOposto(ultimo));
+                int saidaInvertida = solucao.saida(passoOposto(primeiro));
+                long long internoInvertido = (R[i + tamanho - 1] - R[i]) - (F[i + tamanho - 1] - F[i]);
+
+                // Lacuna g: entre as posições g-1 e g da rota atual
+                auto avaliar = [&](int g, bool invertido)
                 {
-                    if (pos >= i && pos <= i + segSize)
-                        continue;
-
-                    // Calcular custo de inserção
-                    short custoInsercao = 0;
-                    if (pos > 0 && pos < rota.size())
+                    if (g < 0 || (g >= i && g <= i + tamanho) || (invertido && !podeInverter))
+                        return;
+                    int u = solucao.saidaEm(r, g - 1), v = solucao.entradaEm(r, g);
+                    long long d = remocao - dist(u, v) +
+                                  (invertido ? dist(u, entradaInvertida) + dist(saidaInvertida, v) + internoInvertido
+                                             : dist(u, solucao.entrada(primeiro)) + dist(solucao.saida(ultimo), v));
+                    if (d < melhorDelta)
                     {
-                        short u_antes = (pos > 0) ? std::get<3>(rota[pos - 1]) : deposito;
-                        short v_seg = std::get<2>(segmento[0]);
-                        short u_seg = std::get<3>(segmento.back());
-                        short v_depois = (pos < rota.size()) ? std::get<2>(rota[pos]) : deposito;
-
-                        const auto &dist_antes = obterDistancias(u_antes);
-                        const auto &dist_seg = obterDistancias(u_seg);
-                        custoInsercao = dist_antes[v_seg] + dist_seg[v_depois];
+                        melhorDelta = d;
+                        melhorLacuna = g;
+                        melhorTamanho = tamanho;
+                        melhorInvertido = invertido;
                     }
-
-                    short ganho = custoRemocao - custoInsercao;
-                    if (ganho > melhorGanho)
+                };
+                // Só as lacunas que criam a ligação com o vizinho y (y logo antes
+                // do trecho que começa pela ponta, ou logo depois do trecho que
+                // termina nela) e só se ela for mais curta que a ligação que a
+                // ponta perde: critério de ganho das vizinhanças granulares
+                int perdaInicio = dist(pre, solucao.entrada(primeiro));
+                int perdaFim = dist(solucao.saida(ultimo), pos);
+                for (const int *it = vizinhos.inicio(x); it != vizinhos.fim(x); ++it)
+                    if (solucao.rotaDe[*it] == r)
                     {
-                        melhorGanho = ganho;
-                        melhorPos = pos;
-                        melhorou = true;
+                        int j = solucao.posicaoDe[*it];
+                        if (dist(solucao.saida(rota[j]), solucao.entrada(primeiro)) < perdaInicio)
+                            avaliar(j + 1, false);
+                        if (dist(saidaInvertida, solucao.entrada(rota[j])) < perdaInicio)
+                            avaliar(j, true);
                     }
-                }
-
-                if (melhorou)
-                {
-                    rota.insert(rota.begin() + melhorPos, segmento.begin(), segmento.end());
-                    return true;
-                }
-                else
+                int idUltimo = servicoDo(ultimo);
+                for (const int *it = vizinhos.inicio(idUltimo); it != vizinhos.fim(idUltimo); ++it)
+                    if (solucao.rotaDe[*it] == r)
+                    {
+                        int j = solucao.posicaoDe[*it];
+                        if (dist(solucao.saida(ultimo), solucao.entrada(rota[j])) < perdaFim)
+                            avaliar(j, false);
+                        if (dist(solucao.saida(rota[j]), entradaInvertida) < perdaFim)
+                            avaliar(j + 1, true);
+                    }
+                for (int g : {0, n})
                 {
-                    // Restaurar posição original
-                    rota.insert(rota.begin() + i, segmento.begin(), segmento.end());
+                    avaliar(g, false);
+                    avaliar(g, true);
                 }
             }
+            if (melhorLacuna == -1)
+                continue;
+
+            // Aplica: o trecho vai para a lacuna e, se for o caso, é invertido
+            int g = melhorLacuna, tamanho = melhorTamanho, inicioTrecho, de, ate, fechada;
+            if (g < i)
+            {
+                std::rotate(rota.begin() + g, rota.begin() + i, rota.begin() + i + tamanho);
+                inicioTrecho = de = g;
+                ate = i + tamanho - 1;
+                fechada = i + tamanho;
+            }
+            else
+            {
+                std::rotate(rota.begin() + i, rota.begin() + i + tamanho, rota.begin() + g);
+                inicioTrecho = g - tamanho;
+                de = fechada = i;
+                ate = g - 1;
+            }
+            if (melhorInvertido)
+            {
+                std::reverse(rota.begin() + inicioTrecho, rota.begin() + inicioTrecho + tamanho);
+                for (int p = inicioTrecho; p < inicioTrecho + tamanho; ++p)
+                    rota[p] = passoOposto(rota[p]);
+            }
+            solucao.custo[r] += melhorDelta;
+            solucao.reindexar(r, de, ate);
+            calcularPrefixos(solucao, r, F, R, de);
+            melhorou = true;
+            for (int j : {inicioTrecho, inicioTrecho + tamanho, fechada})
+                enfileirarAntes(j);
         }
-        return false;
+        return melhorou;
     }
 
-    // Or-opt inter-rotas otimizado
-    bool aplicarOrOptInterRotas(std::vector<Rota> &rotas)
+    // Or-opt inter-rotas: leva um serviço x para outra rota com capacidade, na
+    // lacuna e no sentido de menor custo. O delta é exato e sai dos custos já
+    // guardados por rota: a remoção troca pre -> x -> pos por pre -> pos (e
+    // tira o custo de serviço de x), a inserção troca u -> v por u -> x -> v.
+    // As rotas de destino são as dos vizinhos de lista de x, com todas as
+    // lacunas de cada uma. Só aplica movimentos que reduzem o custo total; a
+    // rota que fica vazia sai da solução.
+    bool aplicarOrOptInterRotas(SolucaoRotas &solucao)
     {
-        for (size_t r1 = 0; r1 < rotas.size(); ++r1)
+        auto dist = funcaoDistancia();
+        thread_local std::vector<int> rotaVista;
+        thread_local int carimbo = 0;
+        bool melhorou = false;
+        for (int x = 1; x <= maxServicoId; ++x)
         {
-            if (rotas[r1].size() <= 2)
+            int r1 = solucao.rotaDe[x];
+            if (r1 < 0)
                 continue;
-
-            for (size_t i = 1; i < rotas[r1].size() - 1; ++i)
+            int i = solucao.posicaoDe[x], passo = solucao.passos[r1][i];
+            int pre = solucao.saidaEm(r1, i - 1), pos = solucao.entradaEm(r1, i + 1);
+            long long remocao = dist(pre, pos) - dist(pre, solucao.entrada(passo)) -
+                                dist(solucao.saida(passo), pos) - tabela.custo[x];
+
+            if ((int)rotaVista.size() < solucao.qtdRotas())
+                rotaVista.resize(solucao.qtdRotas(), 0);
+            ++carimbo;
+            long long melhorDelta = 0;
+            int melhorRota = -1, melhorLacuna = -1, melhorPasso = passo;
+            for (const int *it = vizinhos.inicio(x); it != vizinhos.fim(x); ++it)
             {
-                if (std::get<0>(rotas[r1][i]) != 1)
+                int r2 = solucao.rotaDe[*it];
+                if (r2 < 0 || r2 == r1 || rotaVista[r2] == carimbo ||
+                    solucao.carga[r2] + tabela.demanda[x] > capacidadeVeiculo)
                     continue;
-
-                short demandaServico = mapaDemanda[std::get<1>(rotas[r1][i])];
-
-                // Procurar rota com menor carga que possa receber o serviço
-                size_t melhorRota = rotas.size();
-                short menorCarga = capacidadeVeiculo + 1;
-
-                for (size_t r2 = 0; r2 < rotas.size(); ++r2)
+                rotaVista[r2] = carimbo;
+                for (int g = 0; g <= (int)solucao.passos[r2].size(); ++g)
                 {
-                    if (r1 == r2)
-                        continue;
-
-                    short cargaR2 = calcularCargaRota(rotas[r2]);
-                    if (cargaR2 + demandaServico <= capacidadeVeiculo && cargaR2 < menorCarga)
+                    int u = solucao.saidaEm(r2, g - 1), v = solucao.entradaEm(r2, g);
+                    long long base = remocao + tabela.custo[x] - dist(u, v);
+                    for (int sentido = 0; sentido < (tabela.reversivel[x] ? 2 : 1); ++sentido)
                     {
-                        menorCarga = cargaR2;
-                        melhorRota = r2;
+                        int p = passoDe(x, sentido == 1);
+                        long long d = base + dist(u, solucao.entrada(p)) + dist(solucao.saida(p), v);
+                        if (d < melhorDelta)
+                        {
+                            melhorDelta = d;
+                            melhorRota = r2;
+                            melhorLacuna = g;
+                            melhorPasso = p;
+                        }
                     }
                 }
-
-                if (melhorRota < rotas.size())
-                {
-                    auto servico = rotas[r1][i];
-                    rotas[r1].erase(rotas[r1].begin() + i);
-
-                    // Inserir na melhor posição da rota escolhida
-                    size_t melhorPos = 1;
-                    rotas[melhorRota].insert(rotas[melhorRota].begin() + melhorPos, servico);
-
-                    return true;
-                }
             }
+            if (melhorRota == -1)
+                continue;
+
+            std::vector<int> &origem = solucao.passos[r1], &destino = solucao.passos[melhorRota];
+            origem.erase(origem.begin() + i);
+            solucao.carga[r1] -= tabela.demanda[x];
+            solucao.custo[r1] += remocao;
+            destino.insert(destino.begin() + melhorLacuna, melhorPasso);
+            solucao.carga[melhorRota] += tabela.demanda[x];
+            solucao.custo[melhorRota] += melhorDelta - remocao;
+            solucao.reindexar(melhorRota, melhorLacuna, (int)destino.size() - 1);
+            if (origem.empty())
+                solucao.removerRota(r1);
+            else
+                solucao.reindexar(r1, i, (int)origem.size() - 1);
+            melhorou = true;
         }
-        return false;
+        return melhorou;
     }
 
     // VNS simplificado com critério de parada baseado em melhoria - MELHORIA 5
-    bool vnsParalelo(std::vector<Rota> &rotas)
+    bool vnsParalelo(SolucaoRotas &solucao)
     {
         bool melhorou = false;
 
         // 1. Aplicar 2-opt em todas as rotas
-        for (auto &rota : rotas)
+        for (int r = 0; r < solucao.qtdRotas(); ++r)
         {
-            if (aplicar2Opt(rota))
+            if (aplicar2Opt(solucao, r))
                 melhorou = true;
         }
 
         // 2. Aplicar Or-opt intra-rota
-        for (auto &rota : rotas)
+        for (int r = 0; r < solucao.qtdRotas(); ++r)
         {
-            if (aplicarOrOpt(rota))
+            if (aplicarOrOpt(solucao, r))
                 melhorou = true;
         }
 
         // 3. Or-opt inter-rotas
-        if (aplicarOrOptInterRotas(rotas))
+        if (aplicarOrOptInterRotas(solucao))
             melhorou = true;
 
         return melhorou;
     }
 
     // Construção gulosa com inserção na melhor posição - MELHORIA 6
-    std::vector<Rota> construcaoGulosaSimplesEficiente(const std::vector<Servico> &servicos)
+    SolucaoRotas construcaoGulosaSimplesEficiente(const std::vector<Servico> &servicos)
     {
         std::vector<bool> servicosUsados(maxServicoId + 1, false);
-        std::vector<Rota> rotas;
+        SolucaoRotas solucao(tabela, deposito);
 
         std::vector<std::pair<double, int>> eficiencias;
         eficiencias.reserve(servicos.size());
@@ -374,7 +582,7 @@ public:
         for (size_t i = 0; i < servicos.size(); ++i)
         {
             const auto &s = servicos[i];
-            double ef = (double)s.custo / std::max((short)1, s.demanda);
+            double ef = (double)s.custo / std::max(1, s.demanda);
             double fatorDistancia = 1.0 + (distDeposito[s.origem] + distDeposito[s.destino]) / 200.0;
             ef *= fatorDistancia;
             eficiencias.emplace_back(ef, i);
@@ -389,29 +597,28 @@ public:
                 continue;
 
             // Encontrar melhor posição de inserção
-            bool adicionado = false;
-            short melhorCustoInsercao = INF;
-            size_t melhorRota = rotas.size();
-            size_t melhorPos = 0;
+            int melhorCustoInsercao = INF;
+            int melhorRota = -1;
+            int melhorPos = 0;
 
-            for (size_t r = 0; r < rotas.size(); ++r)
+            for (int r = 0; r < solucao.qtdRotas(); ++r)
             {
-                short cargaAtual = calcularCargaRota(rotas[r]);
-                if (cargaAtual + s.demanda > capacidadeVeiculo)
+                if (solucao.carga[r] + s.demanda > capacidadeVeiculo)
                     continue;
 
-                // Testar inserção em cada posição
-                for (size_t pos = 1; pos < rotas[r].size(); ++pos)
+                // Testar inserção em cada posição (antes de passos[pos]; pos = tamanho: no fim)
+                int n = (int)solucao.passos[r].size();
+                for (int pos = 0; pos <= n; ++pos)
                 {
-                    short u_ant = (pos > 1) ? std::get<3>(rotas[r][pos - 1]) : deposito;
-                    short v_prox = (pos < rotas[r].size() - 1) ? std::get<2>(rotas[r][pos]) : deposito;
+                    int u_ant = solucao.saidaEm(r, pos - 1);
+                    int v_prox = solucao.entradaEm(r, pos);
 
                     const auto &dist_ant = obterDistancias(u_ant);
                     const auto &dist_serv = obterDistancias(s.destino);
 
-                    short custoInsercao = dist_ant[s.origem] + dist_serv[v_prox];
-                    if (pos < rotas[r].size() - 1)
-                        custoInsercao -= obterDistancias(u_ant)[v_prox];
+                    int custoInsercao = dist_ant[s.origem] + dist_serv[v_prox];
+                    if (pos < n)
+                        custoInsercao -= dist_ant[v_prox];
 
                     if (custoInsercao < melhorCustoInsercao)
                     {
@@ -422,42 +629,49 @@ public:
                 }
             }
 
-            if (melhorRota < rotas.size())
+            if (melhorRota != -1)
             {
-                rotas[melhorRota].insert(rotas[melhorRota].begin() + melhorPos,
-                                         {1, s.id, s.origem, s.destino, s.custo});
-                servicosUsados[s.id] = true;
-                adicionado = true;
-            }
-
-            if (!adicionado)
-            {
-                Rota novaRota;
-                novaRota.reserve(capacidadeVeiculo / 10 + 3);
-                novaRota.emplace_back(0, 0, deposito, deposito, 0);
-                novaRota.emplace_back(1, s.id, s.origem, s.destino, s.custo);
-                novaRota.emplace_back(0, 0, deposito, deposito, 0);
-                rotas.push_back(std::move(novaRota));
-                servicosUsados[s.id] = true;
+                solucao.passos[melhorRota].insert(solucao.passos[melhorRota].begin() + melhorPos, passoDe(s.id, false));
+                solucao.atualizarRota(melhorRota, funcaoDistancia());
             }
+            else
+                solucao.adicionarRota({passoDe(s.id, false)}, funcaoDistancia());
+            servicosUsados[s.id] = true;
         }
 
-        return rotas;
+        return solucao;
+    }
+
+    // Tour gigante pelo vizinho mais próximo (sorteado entre os 3 mais próximos
+    // quando há rng) dividido pelo Split ótimo, com a orientação de cada aresta
+    // requerida escolhida por viagem (comum/split.hpp)
+    SolucaoRotas construcaoPorSplit(std::mt19937 *rng)
+    {
+        auto viagens = construirPorSplit(servicosTour, capacidadeVeiculo, deposito, funcaoDistancia(), rng);
+
+        SolucaoRotas solucao(tabela, deposito);
+        for (const auto &viagem : viagens)
+        {
+            std::vector<int> passos;
+            passos.reserve(viagem.size());
+            for (const auto &passo : viagem)
+                passos.push_back(passoDe(servicosTour[passo.servico].id, passo.invertido));
+            solucao.adicionarRota(std::move(passos), funcaoDistancia());
+        }
+        return solucao;
     }
 
     // Construção gulosa randomizada com RCL adaptativa - MELHORIA 3
-    std::vector<Rota> construcaoGulosaRandomizada(std::mt19937 &rng, const std::vector<Servico> &servicos)
+    SolucaoRotas construcaoGulosaRandomizada(std::mt19937 &rng, const std::vector<Servico> &servicos)
     {
         std::vector<bool> servicosUsados(maxServicoId + 1, false);
-        std::vector<Rota> rotas;
+        SolucaoRotas solucao(tabela, deposito);
 
         size_t servicosRestantes = servicos.size();
         while (servicosRestantes > 0)
         {
-            short capacidadeRestante = capacidadeVeiculo;
-            Rota rota;
-            rota.reserve(capacidadeVeiculo / 20 + 3);
-            rota.emplace_back(0, 0, deposito, deposito, 0);
+            int capacidadeRestante = capacidadeVeiculo;
+            std::vector<int> rota;
 
             while (capacidadeRestante > 0 && servicosRestantes > 0)
             {
@@ -470,7 +684,7 @@ public:
                 {
                     if (servicosUsados[s.id] || s.demanda > capacidadeRestante)
                         continue;
-                    double eficiencia = (double)s.custo / std::max((short)1, s.demanda);
+                    double eficiencia = (double)s.custo / std::max(1, s.demanda);
                     candidatos.emplace_back(eficiencia, &s);
                     melhorEficiencia = std::min(melhorEficiencia, eficiencia);
                 }
@@ -495,27 +709,24 @@ public:
                 const auto &escolhido = *candidatos[escolhido_idx].second;
 
                 capacidadeRestante -= escolhido.demanda;
-                rota.emplace_back(1, escolhido.id, escolhido.origem, escolhido.destino, escolhido.custo);
+                rota.push_back(passoDe(escolhido.id, false));
                 servicosUsados[escolhido.id] = true;
                 servicosRestantes--;
             }
 
-            rota.emplace_back(0, 0, deposito, deposito, 0);
-            if (rota.size() > 2)
-            {
-                rota.shrink_to_fit();
-                rotas.push_back(std::move(rota));
-            }
+            if (!rota.empty())
+                solucao.adicionarRota(std::move(rota), funcaoDistancia());
         }
-        return rotas;
+        return solucao;
     }
 
-    // GRASP com controle inteligente de alpha - MELHORIA 4
-    std::vector<Rota> graspParalelo(const std::vector<Servico> &servicos, int maxIter = 50, int threadId = 0)
+    // GRASP com controle inteligente de alpha - MELHORIA 4. As soluções são
+    // comparadas pelo custo com deslocamentos, mantido por rota em SolucaoRotas
+    SolucaoRotas graspParalelo(const std::vector<Servico> &servicos, int maxIter = 50, int threadId = 0)
     {
         std::mt19937 rng(std::random_device{}() + threadId * 1000);
-        std::vector<Rota> melhorLocal;
-        int menorCustoLocal = 32767;
+        SolucaoRotas melhorLocal;
+        long long menorCustoLocal = LLONG_MAX;
         int iterSemMelhora = 0;
         const int maxSemMelhora = 15;
 
@@ -523,10 +734,10 @@ public:
 
         for (int iter = 0; iter < maxIter && iterSemMelhora < maxSemMelhora; ++iter)
         {
-            int custoGlobal = melhorCustoGlobal.load(std::memory_order_acquire);
+            long long custoGlobal = melhorCustoGlobal.load(std::memory_order_acquire);
 
             // Ajuste mais agressivo baseado na convergência
-            int gap = (menorCustoLocal - custoGlobal);
+            long long gap = (menorCustoLocal - custoGlobal);
             if (gap < menorCustoLocal * 0.05) // Convergiu
             {
                 alpha = std::min(alpha * 1.5, 0.8); // Mais diversificação
@@ -536,9 +747,13 @@ public:
                 alpha = std::max(alpha * 0.7, 0.05); // Mais intensificação
             }
 
-            std::vector<Rota> rotas;
+            SolucaoRotas rotas;
 
-            if (iter % 5 == 0)
+            if (construcaoSplit)
+            {
+                rotas = construcaoPorSplit(iter % 5 == 0 ? nullptr : &rng);
+            }
+            else if (iter % 5 == 0)
             {
                 rotas = construcaoGulosaSimplesEficiente(servicos);
             }
@@ -550,17 +765,17 @@ public:
             // VNS com parada baseada em melhoria efetiva
             for (int vnsIter = 0; vnsIter < 5; ++vnsIter)
             {
-                int custoAntesVNS = custoTotal(rotas);
+                long long custoAntesVNS = rotas.custoTotal();
                 if (!vnsParalelo(rotas))
                     break;
-                int custoDepoisVNS = custoTotal(rotas);
+                long long custoDepoisVNS = rotas.custoTotal();
 
                 // Se melhoria foi marginal, para
                 if (custoAntesVNS - custoDepoisVNS < custoAntesVNS * 0.01)
                     break;
             }
 
-            int custoAtual = custoTotal(rotas);
+            long long custoAtual = rotas.custoTotal();
             if (custoAtual < menorCustoLocal)
             {
                 melhorLocal = rotas;
@@ -581,9 +796,9 @@ public:
         return melhorLocal;
     }
 
-    void atualizarMelhorSolucaoGlobal(const std::vector<Rota> &solucao, int custo)
+    void atualizarMelhorSolucaoGlobal(const SolucaoRotas &solucao, long long custo)
     {
-        int custoAtual = melhorCustoGlobal.load(std::memory_order_acquire);
+        long long custoAtual = melhorCustoGlobal.load(std::memory_order_acquire);
         while (custo < custoAtual &&
                !melhorCustoGlobal.compare_exchange_weak(custoAtual, custo, std::memory_order_release))
         {
@@ -592,7 +807,7 @@ public:
         if (custo < custoAtual)
         {
             std::lock_guard<std::mutex> lock(melhorSolucaoMutex);
-            if (custo < custoTotal(melhorSolucao))
+            if (melhorSolucao.vazia() || custo < melhorSolucao.custoTotal())
             {
                 melhorSolucao = solucao;
             }
@@ -600,17 +815,24 @@ public:
     }
 
 public:
-    void lerArquivo(const std::string &caminho)
+    // Renumera os vértices em ordem RCM a partir do depósito ao carregar a instância
+    void ativarReordenacao() { reordenar = true; }
+
+    // Volta às construções gulosas originais no lugar do tour gigante + Split
+    void usarConstrucaoGulosa() { construcaoSplit = false; }
+
+    bool lerArquivo(const std::string &caminho)
     {
-        std::ifstream arquivo(caminho);
-        if (!arquivo.is_open())
+        DadosInstancia dados;
+        if (!lerInstancia(caminho, dados))
         {
-            std::cerr << "Erro ao abrir arquivo: " << caminho << std::endl;
-            return;
+            reportarErrosLeitura(std::cerr, caminho, dados);
+            return false;
         }
 
-        std::string linha;
-        short id_servico = 1;
+        if (reordenar)
+            reordenacao = reordenarInstancia(dados);
+        int id_servico = 1;
 
         auto pos = caminho.find_last_of("/\\");
         std::string nomeBase = (pos == std::string::npos) ? caminho : caminho.substr(pos + 1);
@@ -621,92 +843,149 @@ public:
         arestasRequeridas.clear();
         arcosRequeridos.clear();
 
-        while (std::getline(arquivo, linha))
+        capacidadeVeiculo = dados.capacidade;
+        deposito = dados.deposito;
+        qtdVertices = dados.qtdVertices;
+
+        nosRequeridos.reserve(dados.nosRequeridos.size());
+        for (const auto &n : dados.nosRequeridos)
+            nosRequeridos.push_back({n.vertice, n.demanda, n.custoServico, id_servico++});
+
+        arestasRequeridas.reserve(dados.arestasRequeridas.size());
+        for (const auto &e : dados.arestasRequeridas)
         {
-            if (linha.rfind("Capacity:", 0) == 0)
-                capacidadeVeiculo = std::stoi(linha.substr(9));
-            else if (linha.rfind("Depot Node:", 0) == 0)
-                deposito = std::stoi(linha.substr(12));
-            else if (linha.rfind("#Nodes:", 0) == 0)
-            {
-                qtdVertices = std::stoi(linha.substr(8));
-                grafo.assign(qtdVertices + 1, {});
-                distanciasCache.assign(qtdVertices + 1, std::vector<short>(qtdVertices + 1, INF));
+            int u = e.origem, v = e.destino, custo = e.custo;
+            arestasRequeridas.push_back({id_servico++, u, v, custo, e.demanda});
+        }
 
-                distanciasCalculadas.resize(qtdVertices + 1);
-                distanciasMutex.resize(qtdVertices + 1);
-                for (int i = 0; i <= qtdVertices; ++i)
-                {
-                    distanciasCalculadas[i] = new std::atomic<bool>(false);
-                    distanciasMutex[i] = std::make_unique<std::mutex>();
-                }
-            }
-            else if (linha.rfind("ReN.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'N')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    short demanda, custo;
-                    ss >> id >> demanda >> custo;
-                    short no = std::stoi(id.substr(1));
-                    nosRequeridos.push_back({no, demanda, custo, id_servico++});
-                }
-            }
-            else if (linha.rfind("ReE.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'E')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    short u, v, custo, demanda, scusto;
-                    ss >> id >> u >> v >> custo >> demanda >> scusto;
-                    arestasRequeridas.push_back({id_servico++, u, v, custo, demanda});
-                    grafo[u].emplace_back(v, custo);
-                    grafo[v].emplace_back(u, custo);
-                }
-            }
-            else if (linha.rfind("ReA.", 0) == 0)
-            {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'A')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    short u, v, custo, demanda, scusto;
-                    ss >> id >> u >> v >> custo >> demanda >> scusto;
-                    arcosRequeridos.push_back({id_servico++, u, v, custo, demanda});
-                    grafo[u].emplace_back(v, custo);
-                }
-            }
-            else if (linha.rfind("EDGE.", 0) == 0)
+        arcosRequeridos.reserve(dados.arcosRequeridos.size());
+        for (const auto &a : dados.arcosRequeridos)
+        {
+            int u = a.origem, v = a.destino, custo = a.custo;
+            arcosRequeridos.push_back({id_servico++, u, v, custo, a.demanda});
+        }
+
+        construirMapas();
+        grafo = construirCSR(dados);
+        distancias.definir(qtdVertices, verticesChave(dados));
+        return true;
+    }
+
+    // Rejeita a instância antes de resolver quando algum serviço não pode ser
+    // atendido: demanda maior que a capacidade ou vértice-chave fora da
+    // componente forte do depósito (comum/condensacao.hpp). Depois dela todo
+    // par de vértices-chave é mutuamente alcançável e nenhuma consulta de
+    // distância do resolvedor devolve infinito.
+    bool verificarViabilidade(std::ostream &erro)
+    {
+        for (int id = 1; id <= maxServicoId; ++id)
+            if (tabela.demanda[id] > capacidadeVeiculo)
             {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'E')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    short u, v, custo, dummy1, dummy2;
-                    ss >> id >> u >> v >> custo >> dummy1 >> dummy2;
-                    grafo[u].emplace_back(v, custo);
-                    grafo[v].emplace_back(u, custo);
-                }
+                erro << nomeBase << ": instancia inviavel, servico " << id << " tem demanda maior que a capacidade\n";
+                return false;
             }
-            else if (linha.rfind("ARC.", 0) == 0)
+        condensacao = Condensacao(grafo);
+        int v = verticeInviavel(condensacao, deposito, distancias.vertices());
+        if (v != 0)
+        {
+            erro << nomeBase << ": instancia inviavel, vertice " << reordenacao.paraOriginal(v)
+                 << (condensacao.alcanca(v, deposito) ? " nao e alcancado pelo deposito\n" : " nao alcanca o deposito\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Aquecimento: calcula em paralelo todas as linhas da tabela de distâncias
+    // entre chaves (Dijkstra por chave, Floyd-Warshall ou hierarquia de
+    // contração, conforme o grafo) e a congela. Toda chave é origem de alguma
+    // consulta da busca (o índice de vizinhos olha todos os pares), então
+    // calcular sob demanda não economiza linhas, e com a tabela pronta as
+    // consultas dos operadores são só leituras, sem atômicos nem travas.
+    void preprocessar(PoolThreads &pool)
+    {
+        calcularChaves(grafo, INF, distancias, pool);
+        consultaDistancias = distancias.consulta();
+    }
+
+    // Altera o custo de uma ligação (ids de vértice do arquivo) e conserta a
+    // tabela de distâncias de forma incremental. As linhas que dependem de
+    // aumentos só são recalculadas em reavaliar(). Devolve false se a ligação
+    // não existir.
+    bool alterarCustoLigacao(int origem, int destino, bool arco, int novoCusto)
+    {
+        origem = reordenacao.paraNovo(origem);
+        destino = reordenacao.paraNovo(destino);
+        if (origem < 1 || origem > qtdVertices || destino < 1 || destino > qtdVertices)
+            return false;
+        if (!atualizador)
+            atualizador = std::make_unique<AtualizadorDistancias>(grafo, distancias, INF);
+        if (!atualizador->alterarCusto(origem, destino, arco, novoCusto, linhasPendentes))
+            return false;
+        // A tabela pode ter sido materializada (cópia própria) pelo atualizador
+        consultaDistancias = distancias.consulta();
+
+        for (auto &s : arco ? arcosRequeridos : arestasRequeridas)
+            if ((s.origem == origem && s.destino == destino) ||
+                (!arco && s.origem == destino && s.destino == origem))
             {
-                while (std::getline(arquivo, linha) && !linha.empty() && linha[0] == 'A')
-                {
-                    std::stringstream ss(linha);
-                    std::string id;
-                    short u, v, custo, dummy1, dummy2;
-                    ss >> id >> u >> v >> custo >> dummy1 >> dummy2;
-                    grafo[u].emplace_back(v, custo);
-                }
+                s.custo = novoCusto;
+                tabela.custo[s.id] = novoCusto;
             }
+        return true;
+    }
+
+    // Recalcula as linhas pendentes e devolve o custo da melhor solução
+    // (serviços + deslocamentos) com as distâncias atualizadas
+    long long reavaliar(PoolThreads &pool)
+    {
+        if (atualizador && !linhasPendentes.empty())
+        {
+            atualizador->recalcularLinhas(linhasPendentes, pool);
+            linhasPendentes.clear();
         }
+        return custoComDeslocamentos(melhorSolucao);
+    }
 
-        construirMapas();
+    // Aplica as alterações do arquivo sobre a melhor solução já construída e
+    // informa o custo antes e depois, sem reconstruir as rotas
+    bool aplicarAlteracoes(const std::string &caminho, PoolThreads &pool, std::ostream &log)
+    {
+        std::vector<AlteracaoCusto> alteracoes;
+        std::string erro;
+        if (!lerAlteracoes(caminho, alteracoes, erro))
+        {
+            log << erro << "\n";
+            return false;
+        }
+
+        long long antes = custoComDeslocamentos(melhorSolucao);
+        auto ini = std::chrono::high_resolution_clock::now();
+        int aplicadas = 0;
+        for (const auto &a : alteracoes)
+        {
+            if (alterarCustoLigacao(a.origem, a.destino, a.arco, a.custo))
+                ++aplicadas;
+            else
+                log << caminho << ": ligacao " << a.origem << " -> " << a.destino << " inexistente\n";
+        }
+        std::size_t recalculadas = linhasPendentes.size();
+        long long depois = reavaliar(pool);
+        auto fim = std::chrono::high_resolution_clock::now();
+
+        log << nomeBase << ": " << aplicadas << " alteracoes, " << recalculadas << "/" << distancias.qtdChaves()
+            << " linhas recalculadas, custo com deslocamentos " << antes << " -> " << depois << " ("
+            << std::chrono::duration_cast<std::chrono::microseconds>(fim - ini).count() / 1000.0 << " ms)\n";
+        return true;
     }
 
-    void construirRotas()
+    std::size_t memoriaEstimada() const
+    {
+        std::size_t n = qtdVertices + 1, k = distancias.qtdChaves();
+        // + componente por vértice e DAG da condensação (no máximo uma ligação por entrada do CSR)
+        return k * k * sizeof(int) + 2 * n * sizeof(int) + grafo.destino.size() * sizeof(int);
+    }
+
+    void construirRotas(PoolThreads &pool)
     {
         std::vector<Servico> todosServicos;
         todosServicos.reserve(nosRequeridos.size() + arestasRequeridas.size() + arcosRequeridos.size());
@@ -718,8 +997,14 @@ public:
         for (auto &a : arcosRequeridos)
             todosServicos.push_back({a.id, a.origem, a.destino, a.custo, a.demanda});
 
+        servicosTour.clear();
+        servicosTour.reserve(todosServicos.size());
+        for (const auto &s : todosServicos)
+            servicosTour.push_back({s.id, s.origem, s.destino, s.custo, s.demanda, tabela.reversivel[s.id] != 0});
+        construirIndiceVizinhos(pool);
+
         int nThreads = std::min(6, (int)std::thread::hardware_concurrency());
-        std::vector<std::future<std::vector<Rota>>> futures;
+        std::vector<std::future<SolucaoRotas>> futures;
         futures.reserve(nThreads);
 
         for (int t = 0; t < nThreads; ++t)
@@ -729,12 +1014,12 @@ public:
                                          { return graspParalelo(todosServicos, maxIter, t); }));
         }
 
-        melhorSolucao.clear();
-        int menorCusto = 32767;
+        melhorSolucao = SolucaoRotas(tabela, deposito);
+        long long menorCusto = LLONG_MAX;
         for (auto &f : futures)
         {
             auto sol = f.get();
-            int custoSol = custoTotal(sol);
+            long long custoSol = sol.custoTotal();
             if (custoSol < menorCusto)
             {
                 menorCusto = custoSol;
@@ -743,63 +1028,160 @@ public:
         }
     }
 
-    void salvarSolucao(long long clocks)
+    // Grava em caminhos-<instancia>.dat a sequência completa de vértices de cada
+    // rota: depósito, deslocamentos expandidos, serviços e volta ao depósito
+    void salvarCaminhos()
+    {
+        std::ofstream out("caminhos-" + nomeBase + ".dat");
+        ExpansorCaminhos expansor(grafo);
+        std::vector<int> caminho;
+        int rota_id = 1;
+        for (const auto &rota : melhorSolucao.passos)
+        {
+            caminho.assign(1, deposito);
+            for (int passo : rota)
+            {
+                int u = melhorSolucao.entrada(passo), v = melhorSolucao.saida(passo);
+                expansor.expandir(caminho.back(), u, caminho);
+                if (v != u)
+                    caminho.push_back(v);
+            }
+            expansor.expandir(caminho.back(), deposito, caminho);
+
+            out << rota_id++ << " " << caminho.size();
+            for (int x : caminho)
+                out << " " << reordenacao.paraOriginal(x);
+            out << "\n";
+        }
+    }
+
+    // Com comCaminhos, grava também os caminhos percorridos (salvarCaminhos)
+    void salvarSolucao(long long clocks, bool comCaminhos = false)
     {
         std::string nomeArquivo = "sol-" + nomeBase + ".dat";
         std::ofstream out(nomeArquivo);
 
-        int custoTotalSol = custoTotal(melhorSolucao);
+        long long custoTotalSol = melhorSolucao.custoServicos();
         out << custoTotalSol << "\n"
-            << melhorSolucao.size() << "\n"
+            << melhorSolucao.qtdRotas() << "\n"
             << clocks << "\n"
             << clocks << "\n";
 
-        short rota_id = 1;
-        for (const auto &rota : melhorSolucao)
+        for (int r = 0; r < melhorSolucao.qtdRotas(); ++r)
         {
-            short demanda = 0, custo = 0;
-            for (const auto &[tipo, id, u, v, c] : rota)
-            {
-                if (tipo == 1)
-                {
-                    demanda += mapaDemanda[id];
-                    custo += mapaCusto[id];
-                }
-            }
-            out << "0 1 " << rota_id++ << " " << demanda << " " << custo << " " << rota.size();
-            for (const auto &[tipo, id, u, v, _] : rota)
-            {
-                if (tipo == 0)
-                    out << " (D " << u << ",1,1)";
-                else
-                    out << " (S " << id << "," << u << "," << v << ")";
-            }
+            const auto &rota = melhorSolucao.passos[r];
+            int custo = 0;
+            for (int passo : rota)
+                custo += tabela.custo[servicoDo(passo)];
+            out << "0 1 " << r + 1 << " " << melhorSolucao.carga[r] << " " << custo << " " << rota.size() + 2;
+            out << " (D " << reordenacao.paraOriginal(deposito) << ",1,1)";
+            for (int passo : rota)
+                out << " (S " << servicoDo(passo) << "," << reordenacao.paraOriginal(melhorSolucao.entrada(passo)) << ","
+                    << reordenacao.paraOriginal(melhorSolucao.saida(passo)) << ")";
+            out << " (D " << reordenacao.paraOriginal(deposito) << ",1,1)";
             out << "\n";
         }
         out.close();
+
+        if (comCaminhos)
+            salvarCaminhos();
     }
 };
 
-int main()
+struct ItemSolucao
+{
+    Instancia instancia;
+    long long tempo = 0;
+    std::string alteracoes; // arquivo <instancia>.alt, se existir
+};
+
+int main(int argc, char *argv[])
 {
     SetConsoleOutputCP(CP_UTF8);
     std::string pasta = "dados/";
 
-    for (const auto &entrada : std::filesystem::directory_iterator(pasta))
+    ConfiguracaoPipeline config;
+    bool reordenar = false;
+    bool caminhos = false;
+    bool construcaoGulosa = false;
+    for (int i = 1; i < argc; ++i)
     {
-        if (entrada.path().extension() == ".dat")
+        if (std::string(argv[i]) == "--reordenar")
+            reordenar = true;
+        else if (std::string(argv[i]) == "--caminhos")
+            caminhos = true;
+        else if (std::string(argv[i]) == "--construcao-gulosa")
+            construcaoGulosa = true;
+        else
         {
-            std::cout << "Processando: " << entrada.path().filename() << std::endl;
-            Instancia instancia;
-            instancia.lerArquivo(entrada.path().string());
-            auto ini = std::chrono::high_resolution_clock::now();
-            instancia.construirRotas();
-            auto fim = std::chrono::high_resolution_clock::now();
-            long long tempo = std::chrono::duration_cast<std::chrono::nanoseconds>(fim - ini).count();
-            instancia.salvarSolucao(tempo);
+            ResultadoOpcao resultado = lerOpcaoPipeline(argc, argv, i, config);
+            if (resultado == ResultadoOpcao::Desconhecida)
+                std::cerr << "Opção desconhecida: " << argv[i] << "\n";
+            if (resultado != ResultadoOpcao::Aceita)
+                return 1;
         }
     }
 
+    std::vector<std::string> entradas;
+    for (const auto &entrada : std::filesystem::directory_iterator(pasta))
+        if (entrada.path().extension() == ".dat")
+            entradas.push_back(entrada.path().string());
+
+    std::mutex mtxSaida;
+    EtapasPipeline<ItemSolucao> etapas;
+    etapas.ler = [&](const std::string &caminho) -> std::unique_ptr<ItemSolucao>
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtxSaida);
+            std::cout << "Processando: " << std::filesystem::path(caminho).filename() << std::endl;
+        }
+        auto item = std::make_unique<ItemSolucao>();
+        if (reordenar)
+            item->instancia.ativarReordenacao();
+        if (construcaoGulosa)
+            item->instancia.usarConstrucaoGulosa();
+        if (!item->instancia.lerArquivo(caminho))
+            return nullptr;
+        {
+            std::ostringstream erro;
+            if (!item->instancia.verificarViabilidade(erro))
+            {
+                std::lock_guard<std::mutex> lock(mtxSaida);
+                std::cerr << erro.str();
+                return nullptr;
+            }
+        }
+        auto caminhoAlteracoes = std::filesystem::path(caminho).replace_extension(".alt");
+        std::error_code ec;
+        if (std::filesystem::exists(caminhoAlteracoes, ec))
+            item->alteracoes = caminhoAlteracoes.string();
+        return item;
+    };
+    etapas.memoria = [](const ItemSolucao &item)
+    { return item.instancia.memoriaEstimada(); };
+    PoolsPipeline pools(entradas.size());
+    etapas.preprocessar = [&](ItemSolucao &item)
+    { item.instancia.preprocessar(pools.preparo()); };
+    etapas.resolver = [&](ItemSolucao &item)
+    {
+        auto ini = std::chrono::high_resolution_clock::now();
+        item.instancia.construirRotas(pools.resolucao());
+        auto fim = std::chrono::high_resolution_clock::now();
+        item.tempo = std::chrono::duration_cast<std::chrono::nanoseconds>(fim - ini).count();
+
+        if (!item.alteracoes.empty())
+        {
+            std::ostringstream log;
+            item.instancia.aplicarAlteracoes(item.alteracoes, pools.resolucao(), log);
+            std::lock_guard<std::mutex> lock(mtxSaida);
+            std::cout << log.str();
+        }
+    };
+    etapas.escrever = [&](ItemSolucao &item)
+    { item.instancia.salvarSolucao(item.tempo, caminhos); };
+
+    executarPipeline(entradas, config, etapas);
+
     std::cout << "Todas as soluções foram geradas com sucesso!\n";
     return 0;
 }
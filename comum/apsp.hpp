@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "floyd_warshall.hpp"
+#include "grafo_csr.hpp"
+#include "hierarquia_contracao.hpp"
+#include "motor_dijkstra.hpp"
+#include "oraculo_chaves.hpp"
+#include "pool_threads.hpp"
+
+// Caminhos mínimos entre vários pares. Escolhe entre Dijkstra a partir de cada
+// origem (grafos esparsos) e Floyd–Warshall em blocos (grafos densos ou
+// pequenos), e distribui o trabalho entre as threads do pool; cada thread usa
+// o seu próprio MotorDijkstra como área de rascunho. Para tabelas com muitas
+// chaves em redes grandes usa uma hierarquia de contração, também pelo
+// modelo de custo.
+
+enum class AlgoritmoAPSP
+{
+    Automatico,
+    Dijkstra,
+    FloydWarshall,
+    Hierarquia
+};
+
+inline const char *nomeAlgoritmo(AlgoritmoAPSP a)
+{
+    switch (a)
+    {
+    case AlgoritmoAPSP::Dijkstra:
+        return "Dijkstra";
+    case AlgoritmoAPSP::FloydWarshall:
+        return "Floyd-Warshall";
+    case AlgoritmoAPSP::Hierarquia:
+        return "hierarquia de contracao";
+    default:
+        return "automatico";
+    }
+}
+
+// Modelo de custo para uma tabela origens × origens: Dijkstra visita as E
+// entradas e os V vértices por origem; Floyd–Warshall faz passo³ relaxações
+// vetorizadas, com a matriz completada até múltiplo do bloco; a hierarquia de
+// contração paga a construção, ~(V + E)·log V, mais uma busca de subida por
+// origem (uma fração pequena de um Dijkstra) e o cruzamento dos baldes, por
+// par. Constantes medidas por núcleo, na escala do Dijkstra: ~8 ns por
+// visita no Dijkstra, ~0,08 ns por relaxação no Floyd–Warshall e, na
+// hierarquia, ~580 ns por (V + E)·log2 V na construção, ~0,45 ns por (V + E)
+// em cada busca e ~15 ns por par. Numa grade de 90 mil vértices a hierarquia
+// só compensa a partir de ~1200 chaves (200 chaves: 3,0 s contra 0,5 s do
+// Dijkstra; 4000 chaves: 3,5 s contra 9,4 s). Com densidade alta o
+// Floyd–Warshall vence, principalmente quando há uma origem por vértice.
+inline AlgoritmoAPSP escolherAPSP(const GrafoCSR &g, int qtdOrigens)
+{
+    constexpr double NS_VISITA_DIJKSTRA = 8.0;
+    constexpr double NS_RELAXACAO_FW = 0.08;
+    constexpr double NS_CONSTRUCAO_CH = 580.0;
+    constexpr double NS_BUSCA_CH = 0.45;
+    constexpr double NS_PAR_CH = 15.0;
+    double v = g.qtdVertices, e = g.qtdEntradas(), k = qtdOrigens;
+    double passo = FloydWarshallBlocado::passoPara(g.qtdVertices + 1);
+    double custoDijkstra = k * (e + v) * NS_VISITA_DIJKSTRA;
+    double custoFW = passo * passo * passo * NS_RELAXACAO_FW;
+    double custoCH = (e + v) * std::log2(std::max(2.0, v)) * NS_CONSTRUCAO_CH + k * (e + v) * NS_BUSCA_CH +
+                     k * k * NS_PAR_CH;
+    if (custoCH < custoDijkstra && custoCH < custoFW)
+        return AlgoritmoAPSP::Hierarquia;
+    return custoFW < custoDijkstra ? AlgoritmoAPSP::FloydWarshall : AlgoritmoAPSP::Dijkstra;
+}
+
+// Executa Dijkstra a partir de cada origem em paralelo; saida(indice, dist, pred)
+// recebe os vetores da origem origens[indice] (pred nulo sem comPred).
+template <typename Saida>
+void dijkstraMultiOrigem(const GrafoCSR &g, int inf, const std::vector<int> &origens, bool comPred,
+                         PoolThreads &pool, Saida &&saida)
+{
+    std::vector<MotorDijkstra> motores(pool.tamanho());
+    pool.paraCada(0, (int)origens.size(), [&](int i, int t)
+                  {
+                      MotorDijkstra &motor = motores[t];
+                      if (!motor.preparado())
+                          motor.preparar(g, inf, comPred);
+                      const int *dist = motor.executar(origens[i]);
+                      saida(i, dist, comPred ? motor.antecessores() : nullptr); });
+}
+
+// Preenche a tabela do oráculo (uma linha por vértice-chave). Distâncias
+// inalcançáveis ficam com inf. Devolve o algoritmo usado.
+inline AlgoritmoAPSP calcularChaves(const GrafoCSR &g, int inf, OraculoChaves &oraculo, PoolThreads &pool,
+                                    AlgoritmoAPSP algoritmo = AlgoritmoAPSP::Automatico)
+{
+    if (algoritmo == AlgoritmoAPSP::Automatico)
+        algoritmo = escolherAPSP(g, oraculo.qtdChaves());
+
+    oraculo.alocar(inf);
+    if (algoritmo == AlgoritmoAPSP::Hierarquia)
+    {
+        HierarquiaContracao ch;
+        ch.construir(g);
+        ch.muitosParaMuitos(oraculo.vertices(), oraculo.vertices(), inf, pool, [&](int k, const int *linha)
+                            { std::memcpy(oraculo.linha(k), linha, oraculo.qtdChaves() * sizeof(int)); });
+        return algoritmo;
+    }
+
+    if (algoritmo == AlgoritmoAPSP::FloydWarshall)
+    {
+        // O núcleo soma dois valores; o infinito interno precisa de folga
+        const int infFW = INT_MAX / 2 - 1;
+        MatrizAlinhada dist;
+        floydWarshallCSR(g, infFW, dist, pool);
+        pool.paraCada(0, oraculo.qtdChaves(), [&](int k, int)
+                      {
+                          int *linha = oraculo.linha(k);
+                          const int *d = dist[oraculo.vertice(k)];
+                          for (int j = 0; j < oraculo.qtdChaves(); ++j)
+                          {
+                              int valor = d[oraculo.vertice(j)];
+                              linha[j] = valor >= infFW ? inf : valor;
+                          } });
+        return algoritmo;
+    }
+
+    dijkstraMultiOrigem(g, inf, oraculo.vertices(), false, pool, [&](int k, const int *d, const int *)
+                        { oraculo.preencherLinha(k, d); });
+    return algoritmo;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Mapeia um arquivo inteiro em memória somente leitura (RAII).
+// O conteúdo é acessado direto das páginas do sistema, sem cópia para buffers.
+class ArquivoMapeado
+{
+private:
+    const char *inicio = nullptr;
+    std::size_t bytes = 0;
+#ifdef _WIN32
+    HANDLE arquivo = INVALID_HANDLE_VALUE;
+    HANDLE mapeamento = nullptr;
+#endif
+
+    void fechar()
+    {
+#ifdef _WIN32
+        if (inicio && bytes > 0)
+            UnmapViewOfFile(inicio);
+        if (mapeamento)
+            CloseHandle(mapeamento);
+        if (arquivo != INVALID_HANDLE_VALUE)
+            CloseHandle(arquivo);
+        mapeamento = nullptr;
+        arquivo = INVALID_HANDLE_VALUE;
+#else
+        if (inicio && bytes > 0)
+            munmap(const_cast<char *>(inicio), bytes);
+#endif
+        inicio = nullptr;
+        bytes = 0;
+    }
+
+public:
+    ArquivoMapeado() = default;
+    ArquivoMapeado(const ArquivoMapeado &) = delete;
+    ArquivoMapeado &operator=(const ArquivoMapeado &) = delete;
+
+    ArquivoMapeado(ArquivoMapeado &&outro) noexcept { *this = std::move(outro); }
+    ArquivoMapeado &operator=(ArquivoMapeado &&outro) noexcept
+    {
+        if (this != &outro)
+        {
+            fechar();
+            inicio = outro.inicio;
+            bytes = outro.bytes;
+            outro.inicio = nullptr;
+            outro.bytes = 0;
+#ifdef _WIN32
+            arquivo = outro.arquivo;
+            mapeamento = outro.mapeamento;
+            outro.arquivo = INVALID_HANDLE_VALUE;
+            outro.mapeamento = nullptr;
+#endif
+        }
+        return *this;
+    }
+
+    ~ArquivoMapeado() { fechar(); }
+
+    bool abrir(const std::string &caminho)
+    {
+        fechar();
+#ifdef _WIN32
+        arquivo = CreateFileA(caminho.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (arquivo == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER tam;
+        if (!GetFileSizeEx(arquivo, &tam))
+        {
+            fechar();
+            return false;
+        }
+        bytes = static_cast<std::size_t>(tam.QuadPart);
+        if (bytes == 0)
+        {
+            inicio = "";
+            return true;
+        }
+        mapeamento = CreateFileMappingA(arquivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapeamento)
+        {
+            fechar();
+            return false;
+        }
+        inicio = static_cast<const char *>(MapViewOfFile(mapeamento, FILE_MAP_READ, 0, 0, 0));
+        if (!inicio)
+        {
+            fechar();
+            return false;
+        }
+#else
+        int fd = ::open(caminho.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        bytes = static_cast<std::size_t>(info.st_size);
+        if (bytes == 0)
+        {
+            ::close(fd);
+            inicio = "";
+            return true;
+        }
+        void *p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            bytes = 0;
+            return false;
+        }
+        madvise(p, bytes, MADV_SEQUENTIAL);
+        inicio = static_cast<const char *>(p);
+#endif
+        return true;
+    }
+
+    const char *dados() const { return inicio; }
+    std::size_t tamanho() const { return bytes; }
+    bool aberto() const { return inicio != nullptr; }
+};
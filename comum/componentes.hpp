@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "grafo_csr.hpp"
+#include "pool_threads.hpp"
+
+// Componentes de grafos grandes sem recursão: união-busca paralela para
+// componentes fracas e Tarjan com pilha explícita para componentes fortes.
+// As rotinas recebem um filtro incluir(i) sobre as entradas do CSR, para
+// considerar só arestas, só arcos ou todas as ligações.
+
+// União-busca concorrente sem travas: a ligação de duas raízes é um
+// compare-and-swap que pendura a de maior índice na de menor (o que impede
+// ciclos), e a busca encurta o caminho pela metade a cada passo.
+class UniaoBuscaConcorrente
+{
+private:
+    std::unique_ptr<std::atomic<int>[]> pai;
+    int n = 0;
+
+public:
+    explicit UniaoBuscaConcorrente(int qtd) : pai(new std::atomic<int>[qtd]), n(qtd)
+    {
+        for (int i = 0; i < n; ++i)
+            pai[i].store(i, std::memory_order_relaxed);
+    }
+
+    int encontrar(int x)
+    {
+        while (true)
+        {
+            int p = pai[x].load(std::memory_order_relaxed);
+            if (p == x)
+                return x;
+            int avo = pai[p].load(std::memory_order_relaxed);
+            if (p != avo)
+                pai[x].compare_exchange_weak(p, avo, std::memory_order_relaxed);
+            x = avo;
+        }
+    }
+
+    void unir(int a, int b)
+    {
+        while (true)
+        {
+            a = encontrar(a);
+            b = encontrar(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            int esperado = a;
+            if (pai[a].compare_exchange_strong(esperado, b, std::memory_order_acq_rel))
+                return;
+        }
+    }
+
+    bool raiz(int x) const { return pai[x].load(std::memory_order_relaxed) == x; }
+};
+
+// Quantidade de componentes fracas dos vértices 1..V considerando só as
+// entradas aceitas pelo filtro. Os vértices são processados em blocos,
+// distribuídos entre as threads do pool.
+template <typename Filtro>
+int contarComponentesFracas(const GrafoCSR &g, Filtro &&incluir, PoolThreads &pool)
+{
+    constexpr int BLOCO = 4096;
+    int n = g.qtdVertices + 1;
+    UniaoBuscaConcorrente uf(n);
+    int blocos = (g.qtdVertices + BLOCO - 1) / BLOCO;
+    pool.paraCada(0, blocos, [&](int b, int)
+                  {
+                      int fim = std::min(g.qtdVertices, (b + 1) * BLOCO);
+                      for (int u = b * BLOCO + 1; u <= fim; ++u)
+                          for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+                              if (incluir(i))
+                                  uf.unir(u, g.destino[i]); });
+
+    int total = 0;
+    for (int v = 1; v <= g.qtdVertices; ++v)
+        if (uf.raiz(v))
+            total++;
+    return total;
+}
+
+// Componentes fortemente conexas (Tarjan iterativo) dos vértices 1..V
+// considerando só as entradas aceitas pelo filtro. Preenche componente[v] com
+// o id da componente de v (componente[0] = -1) e devolve a quantidade. Os ids
+// saem em ordem topológica reversa do grafo condensado: se há ligação da
+// componente a para a componente b != a, então a > b.
+template <typename Filtro>
+int componentesFortes(const GrafoCSR &g, Filtro &&incluir, std::vector<int> &componente)
+{
+    int n = g.qtdVertices + 1;
+    std::vector<int> indice(n, -1), baixo(n, 0), pilha;
+    std::vector<std::pair<int, int>> chamadas; // (vértice, próxima entrada a olhar)
+    std::vector<char> naPilha(n, 0);
+    componente.assign(n, -1);
+    int contador = 0, qtd = 0;
+
+    for (int raiz = 1; raiz < n; ++raiz)
+    {
+        if (indice[raiz] != -1)
+            continue;
+        chamadas.push_back({raiz, g.inicio[raiz]});
+        indice[raiz] = baixo[raiz] = contador++;
+        pilha.push_back(raiz);
+        naPilha[raiz] = 1;
+
+        while (!chamadas.empty())
+        {
+            auto &[u, i] = chamadas.back();
+            bool desceu = false;
+            for (; i < g.inicio[u + 1]; ++i)
+            {
+                if (!incluir(i))
+                    continue;
+                int v = g.destino[i];
+                if (indice[v] == -1)
+                {
+                    ++i;
+                    indice[v] = baixo[v] = contador++;
+                    pilha.push_back(v);
+                    naPilha[v] = 1;
+                    chamadas.push_back({v, g.inicio[v]});
+                    desceu = true;
+                    break;
+                }
+                if (naPilha[v])
+                    baixo[u] = std::min(baixo[u], indice[v]);
+            }
+            if (desceu)
+                continue;
+
+            int w = u;
+            chamadas.pop_back();
+            if (baixo[w] == indice[w])
+            {
+                int x;
+                do
+                {
+                    x = pilha.back();
+                    pilha.pop_back();
+                    naPilha[x] = 0;
+                    componente[x] = qtd;
+                } while (x != w);
+                qtd++;
+            }
+            if (!chamadas.empty())
+            {
+                int pai = chamadas.back().first;
+                baixo[pai] = std::min(baixo[pai], baixo[w]);
+            }
+        }
+    }
+    return qtd;
+}
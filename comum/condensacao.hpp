@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "componentes.hpp"
+#include "grafo_csr.hpp"
+
+// Condensação do grafo misto: cada componente fortemente conexa (Tarjan
+// iterativo sobre todas as ligações) vira um vértice de um DAG. Os ids das
+// componentes saem em ordem topológica reversa, então toda ligação entre
+// componentes vai de um id maior para um menor, e u só pode alcançar v se
+// comp(u) >= comp(v).
+//
+// A construção (componentes e DAG) é linear em V + E: as ligações são
+// agrupadas pela componente de origem percorrendo os vértices de cada
+// componente, e as repetidas são descartadas com um carimbo por componente.
+//
+// alcanca(u, v) responde em O(1): mesma componente, ordem topológica e, quando
+// o DAG tem até LIMITE_FECHO componentes, o fecho transitivo em bits. O fecho
+// (O(E_dag · C / 64) de tempo, C² / 8 bytes) só é montado na primeira
+// consulta que precisa dele; em DAGs maiores esse caso cai para uma busca no
+// DAG.
+class Condensacao
+{
+public:
+    static constexpr int LIMITE_FECHO = 8192;
+
+private:
+    std::vector<int> componente;
+    int qtd = 0;
+    // DAG em CSR: sucessores distintos de cada componente
+    std::vector<int> inicio, sucessor;
+    int palavras = 0;
+    bool temFecho = false;
+    std::vector<uint64_t> fecho;
+    std::vector<int> marca, pilha;
+    int carimbo = 0;
+
+    // Sucessores têm id menor, então suas linhas já estão prontas
+    void montarFecho()
+    {
+        palavras = (qtd + 63) / 64;
+        fecho.assign((std::size_t)qtd * palavras, 0);
+        for (int c = 0; c < qtd; ++c)
+        {
+            uint64_t *linha = &fecho[(std::size_t)c * palavras];
+            linha[c / 64] |= 1ull << (c % 64);
+            for (int i = inicio[c]; i < inicio[c + 1]; ++i)
+            {
+                const uint64_t *outra = &fecho[(std::size_t)sucessor[i] * palavras];
+                for (int w = 0; w <= sucessor[i] / 64; ++w)
+                    linha[w] |= outra[w];
+            }
+        }
+        temFecho = true;
+    }
+
+    bool buscarNoDag(int a, int b)
+    {
+        if (marca.empty())
+            marca.assign(qtd, 0);
+        ++carimbo;
+        pilha.assign(1, a);
+        marca[a] = carimbo;
+        while (!pilha.empty())
+        {
+            int c = pilha.back();
+            pilha.pop_back();
+            if (c == b)
+                return true;
+            for (int i = inicio[c]; i < inicio[c + 1]; ++i)
+            {
+                int d = sucessor[i];
+                // Só componentes com id >= b ainda podem chegar a b
+                if (d >= b && marca[d] != carimbo)
+                {
+                    marca[d] = carimbo;
+                    pilha.push_back(d);
+                }
+            }
+        }
+        return false;
+    }
+
+public:
+    Condensacao() = default;
+
+    explicit Condensacao(const GrafoCSR &g)
+    {
+        qtd = componentesFortes(g, [](int)
+                                { return true; }, componente);
+
+        // Vértices agrupados por componente (contagem), depois as ligações de
+        // cada componente na ordem dos seus vértices no CSR; visto[b] == a
+        // indica que a -> b já entrou. Tudo em O(V + E).
+        std::vector<int> primeiro(qtd + 1, 0), ordem(g.qtdVertices);
+        for (int u = 1; u <= g.qtdVertices; ++u)
+            primeiro[componente[u] + 1]++;
+        for (int c = 0; c < qtd; ++c)
+            primeiro[c + 1] += primeiro[c];
+        {
+            std::vector<int> proximo(primeiro.begin(), primeiro.end() - 1);
+            for (int u = 1; u <= g.qtdVertices; ++u)
+                ordem[proximo[componente[u]]++] = u;
+        }
+
+        std::vector<int> visto(qtd, -1);
+        inicio.assign(qtd + 1, 0);
+        sucessor.clear();
+        for (int a = 0; a < qtd; ++a)
+        {
+            for (int p = primeiro[a]; p < primeiro[a + 1]; ++p)
+            {
+                int u = ordem[p];
+                for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+                {
+                    int b = componente[g.destino[i]];
+                    if (b != a && visto[b] != a)
+                    {
+                        visto[b] = a;
+                        sucessor.push_back(b);
+                    }
+                }
+            }
+            inicio[a + 1] = (int)sucessor.size();
+        }
+    }
+
+    int qtdComponentes() const { return qtd; }
+    int componenteDe(int v) const { return componente[v]; }
+    int qtdLigacoesDag() const { return (int)sucessor.size(); }
+    bool mesmaComponente(int u, int v) const { return componente[u] == componente[v]; }
+
+    // v é alcançável a partir de u? A primeira consulta entre componentes
+    // diferentes monta o fecho (ou, em DAG grande, a busca usa buffers
+    // internos): não deve ser chamada por várias threads ao mesmo tempo.
+    bool alcanca(int u, int v)
+    {
+        int a = componente[u], b = componente[v];
+        if (a == b)
+            return true;
+        if (a < b)
+            return false;
+        if (!temFecho && qtd <= LIMITE_FECHO)
+            montarFecho();
+        if (temFecho)
+            return (fecho[(std::size_t)a * palavras + b / 64] >> (b % 64)) & 1;
+        return buscarNoDag(a, b);
+    }
+};
+
+// Verifica se todos os serviços podem ser atendidos por rotas que saem e voltam
+// ao depósito: cada vértice-chave precisa alcançar o depósito e ser alcançado
+// por ele, isto é, estar na mesma componente forte. Devolve o primeiro
+// vértice que viola a condição, ou 0 se a instância for viável.
+inline int verticeInviavel(const Condensacao &c, int deposito, const std::vector<int> &chaves)
+{
+    for (int v : chaves)
+        if (!c.mesmaComponente(deposito, v))
+            return v;
+    return 0;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "apsp.hpp"
+#include "grafo_csr.hpp"
+#include "motor_dijkstra.hpp"
+#include "oraculo_chaves.hpp"
+#include "pool_threads.hpp"
+
+// Atualização incremental da tabela de vértices-chave quando o custo de uma
+// ligação a -> b muda de w para w'. Só duas buscas por sentido da ligação
+// (saindo de b no grafo e saindo de a no grafo reverso) são necessárias para
+// decidir o que muda:
+//  - redução (w' < w): d'(i, j) = min(d(i, j), d(i, a) + w' + d(b, j)),
+//    aplicada a todos os pares em O(K²), sem nova busca por chave;
+//  - aumento (w' > w): só as linhas i em que a ligação estava justa antes da
+//    alteração, d(i, a) + w == d(i, b), podem piorar; elas são devolvidas
+//    para recálculo.
+// Uma aresta é tratada como as duas ligações a -> b e b -> a.
+class AtualizadorDistancias
+{
+private:
+    GrafoCSR &g;
+    GrafoCSR reverso;
+    OraculoChaves &oraculo;
+    int inf;
+    MotorDijkstra frente, tras;
+    std::vector<int> ateA, deB;
+
+    void prepararMotores()
+    {
+        frente.preparar(g, inf);
+        tras.preparar(reverso, inf);
+    }
+
+    // Distância de cada chave até a e de b até cada chave
+    void distanciasPelaLigacao(int a, int b)
+    {
+        int k = oraculo.qtdChaves();
+        const int *paraA = tras.executar(a);
+        ateA.resize(k);
+        for (int i = 0; i < k; ++i)
+            ateA[i] = paraA[oraculo.vertice(i)];
+        const int *saindoB = frente.executar(b);
+        deB.resize(k);
+        for (int j = 0; j < k; ++j)
+            deB[j] = saindoB[oraculo.vertice(j)];
+    }
+
+    void reduzir(int a, int b, int peso)
+    {
+        distanciasPelaLigacao(a, b);
+        int k = oraculo.qtdChaves();
+        for (int i = 0; i < k; ++i)
+        {
+            if (ateA[i] >= inf)
+                continue;
+            int *linha = oraculo.linha(i);
+            int base = ateA[i] + peso;
+            for (int j = 0; j < k; ++j)
+                if (deB[j] < inf && base + deB[j] < linha[j])
+                    linha[j] = base + deB[j];
+        }
+    }
+
+    void marcarJustas(int a, int b, int pesoAntigo, std::vector<char> &afetada)
+    {
+        int k = oraculo.qtdChaves();
+        const int *paraA = tras.executar(a);
+        ateA.resize(k);
+        for (int i = 0; i < k; ++i)
+            ateA[i] = paraA[oraculo.vertice(i)];
+        const int *paraB = tras.executar(b);
+        for (int i = 0; i < k; ++i)
+            if (ateA[i] < inf && ateA[i] + pesoAntigo == paraB[oraculo.vertice(i)])
+                afetada[i] = 1;
+    }
+
+public:
+    // O oráculo deve estar calculado para o grafo atual; inf é o valor de
+    // distância inalcançável usado na tabela
+    AtualizadorDistancias(GrafoCSR &grafo, OraculoChaves &o, int infinito)
+        : g(grafo), reverso(transpor(grafo)), oraculo(o), inf(infinito)
+    {
+        oraculo.materializar();
+        prepararMotores();
+    }
+
+    // Troca o custo da ligação origem -> destino (arco) ou origem -- destino
+    // (aresta) e conserta a tabela. Reduções são aplicadas na hora; as chaves
+    // cujas linhas precisam ser recalculadas por causa de aumentos são
+    // acrescentadas a linhasAfetadas (sem repetição). Devolve false se a
+    // ligação não existir.
+    bool alterarCusto(int origem, int destino, bool arco, int novoCusto, std::vector<int> &linhasAfetadas)
+    {
+        bool existe = false;
+        for (int i = g.inicio[origem]; i < g.inicio[origem + 1] && !existe; ++i)
+            existe = g.destino[i] == destino && (bool)g.ehArco[i] == arco;
+        if (!existe)
+            return false;
+
+        std::vector<char> afetada(oraculo.qtdChaves(), 0);
+        for (int i : linhasAfetadas)
+            afetada[i] = 1;
+
+        // A justeza é testada com as distâncias de antes da alteração
+        int antigoIda = menorPeso(g, origem, destino);
+        int antigoVolta = arco ? INT_MAX : menorPeso(g, destino, origem);
+        if (novoCusto > antigoIda)
+            marcarJustas(origem, destino, antigoIda, afetada);
+        if (!arco && novoCusto > antigoVolta)
+            marcarJustas(destino, origem, antigoVolta, afetada);
+
+        alterarPeso(g, origem, destino, arco, novoCusto);
+        alterarPeso(reverso, destino, origem, arco, novoCusto);
+        prepararMotores();
+
+        int novoIda = menorPeso(g, origem, destino);
+        if (novoIda < antigoIda)
+            reduzir(origem, destino, novoIda);
+        if (!arco)
+        {
+            int novoVolta = menorPeso(g, destino, origem);
+            if (novoVolta < antigoVolta)
+                reduzir(destino, origem, novoVolta);
+        }
+
+        linhasAfetadas.clear();
+        for (int i = 0; i < oraculo.qtdChaves(); ++i)
+            if (afetada[i])
+                linhasAfetadas.push_back(i);
+        return true;
+    }
+
+    // Recalcula as linhas indicadas em paralelo (Dijkstra por chave)
+    void recalcularLinhas(const std::vector<int> &linhas, PoolThreads &pool)
+    {
+        std::vector<int> origens(linhas.size());
+        for (std::size_t i = 0; i < linhas.size(); ++i)
+            origens[i] = oraculo.vertice(linhas[i]);
+        dijkstraMultiOrigem(g, inf, origens, false, pool, [&](int i, const int *d, const int *)
+                            { oraculo.preencherLinha(linhas[i], d); });
+    }
+};
+
+// Alteração de custo de uma ligação, nos ids de vértice do arquivo
+struct AlteracaoCusto
+{
+    int origem, destino;
+    bool arco;
+    int custo;
+};
+
+// Lê um arquivo de alterações: uma por linha, "E u v custo" (aresta) ou
+// "A u v custo" (arco); linhas vazias e iniciadas por # são ignoradas.
+// Devolve false se o arquivo não abrir ou tiver linha inválida.
+inline bool lerAlteracoes(const std::string &caminho, std::vector<AlteracaoCusto> &alteracoes, std::string &erro)
+{
+    std::ifstream in(caminho);
+    if (!in)
+    {
+        erro = "nao foi possivel abrir " + caminho;
+        return false;
+    }
+    std::string linha;
+    for (int numero = 1; std::getline(in, linha); ++numero)
+    {
+        std::istringstream ss(linha);
+        std::string tipo;
+        if (!(ss >> tipo) || tipo[0] == '#')
+            continue;
+        AlteracaoCusto a;
+        if ((tipo != "E" && tipo != "A") || !(ss >> a.origem >> a.destino >> a.custo) || a.custo < 0)
+        {
+            erro = caminho + ":" + std::to_string(numero) + ": alteracao invalida";
+            return false;
+        }
+        a.arco = tipo == "A";
+        alteracoes.push_back(a);
+    }
+    return true;
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "componentes.hpp"
+#include "grafo_csr.hpp"
+#include "intermediacao.hpp"
+#include "motor_dijkstra.hpp"
+#include "pool_threads.hpp"
+
+// Estimativas de caminho médio, diâmetro e intermediação para redes grandes
+// demais para a passada por todas as origens. As origens são sorteadas sem
+// reposição e processadas em lotes pela mesma passada de Brandes
+// (comum/intermediacao.hpp); depois de cada lote os intervalos de confiança
+// são recalculados e a amostragem para quando todos atingem o erro relativo
+// pedido, quando o tempo acaba ou quando todas as origens foram usadas (aí o
+// resultado é exato).
+//  - caminho médio: estimador de razão soma/pares sobre as origens sorteadas;
+//  - intermediação: V/k vezes a soma das dependências das k origens, com a
+//    variância amostral de cada vértice; o critério usa a maior meia-largura
+//    relativa à maior intermediação estimada;
+//  - diâmetro: limite inferior pela maior distância vista (varreduras
+//    duplas a partir das origens sorteadas) e, quando alguma origem s alcança
+//    e é alcançada por todos, limite superior excIn(s) + excOut(s), tentado a
+//    cada lote na origem de menor excentricidade ainda não usada. Se o grafo
+//    não for fortemente conexo esse limite não existe e o diâmetro fica fora
+//    do critério de parada (só o limite inferior é informado).
+// Os erros são meias-larguras de intervalos de 95%, com correção de
+// população finita.
+
+struct ConfiguracaoAproximacao
+{
+    double erroRelativo = 0.05;
+    double tempoMaximo = 10.0; // segundos
+    unsigned semente = 1;
+};
+
+struct Estimativa
+{
+    double valor = 0.0;
+    double erro = 0.0;
+};
+
+struct ResumoAproximado
+{
+    std::vector<Estimativa> intermediacao; // por vértice 1..V; índice 0 sem uso
+    Estimativa caminhoMedio{-1, 0};
+    long long diametroInferior = 0;
+    long long diametroSuperior = -1; // -1 sem limite superior garantido
+    int origensAmostradas = 0;
+    bool exato = false;
+};
+
+class EstimadorCaminhos
+{
+private:
+    static constexpr double Z_95 = 1.96;
+
+    const GrafoCSR &g;
+    const GrafoCSR &reverso;
+    IntermediacaoBrandes brandes;
+
+    // Valores por origem sorteada
+    struct Amostra
+    {
+        int origem;
+        long long soma, pares, excentricidade;
+        int maisDistante;
+    };
+
+    // Busca no grafo reverso: excentricidade de entrada de alvo, vértice que
+    // a realiza e quantos vértices alcançam alvo
+    struct BuscaReversa
+    {
+        long long excentricidade = 0;
+        int maisDistante = 0, alcancados = 0;
+    };
+
+    BuscaReversa buscaReversa(MotorDijkstra &motor, int alvo) const
+    {
+        const int *d = motor.executar(alvo);
+        BuscaReversa r;
+        r.maisDistante = alvo;
+        for (int v = 1; v <= g.qtdVertices; ++v)
+            if (v != alvo && d[v] < INT_MAX)
+            {
+                r.alcancados++;
+                if (d[v] > r.excentricidade)
+                {
+                    r.excentricidade = d[v];
+                    r.maisDistante = v;
+                }
+            }
+        return r;
+    }
+
+    static double meiaLargura(double variancia, int k, int total)
+    {
+        double fpc = 1.0 - (double)k / total;
+        return Z_95 * std::sqrt(std::max(0.0, variancia * fpc / k));
+    }
+
+public:
+    EstimadorCaminhos(const GrafoCSR &grafo, const GrafoCSR &transposto)
+        : g(grafo), reverso(transposto), brandes(grafo, transposto) {}
+
+    ResumoAproximado estimar(const ConfiguracaoAproximacao &config, PoolThreads &pool) const
+    {
+        auto ini = std::chrono::steady_clock::now();
+        int total = g.qtdVertices, n = total + 1;
+        ResumoAproximado r;
+        r.intermediacao.assign(n, {});
+        if (total == 0)
+            return r;
+
+        std::vector<int> ordem(total);
+        std::iota(ordem.begin(), ordem.end(), 1);
+        std::shuffle(ordem.begin(), ordem.end(), std::mt19937(config.semente));
+
+        std::vector<IntermediacaoBrandes::Espaco> espacos(pool.tamanho());
+        for (auto &e : espacos)
+            e.preparar(n, true);
+        std::vector<Amostra> amostras;
+        amostras.reserve(total);
+
+        MotorDijkstra motorReverso;
+        motorReverso.preparar(reverso, INT_MAX);
+        std::vector<char> reversaFeita(n, 0);
+        std::vector<double> soma(n), quadrados(n);
+
+        std::vector<int> componente;
+        bool fortementeConexo = componentesFortes(g, [](int)
+                                                  { return true; }, componente) == 1;
+
+        const int lote = std::max(32, 4 * pool.tamanho());
+        int k = 0;
+        while (k < total)
+        {
+            int fim = std::min(total, k + lote);
+            amostras.resize(fim);
+            pool.paraCada(k, fim, [&](int i, int t)
+                          {
+                              auto &e = espacos[t];
+                              long long somaAntes = e.soma, paresAntes = e.pares;
+                              brandes.origem(ordem[i], e);
+                              int longe = e.ordem.back();
+                              amostras[i] = {ordem[i], e.soma - somaAntes, e.pares - paresAntes,
+                                             e.dist[longe], longe}; });
+
+            // Varredura dupla a partir das novas origens: o mais distante de
+            // cada uma é alvo de uma busca reversa, que também limita por baixo
+            for (int i = k; i < fim; ++i)
+            {
+                r.diametroInferior = std::max(r.diametroInferior, amostras[i].excentricidade);
+                if (i - k < 2 && !reversaFeita[amostras[i].maisDistante])
+                {
+                    reversaFeita[amostras[i].maisDistante] = 1;
+                    BuscaReversa b = buscaReversa(motorReverso, amostras[i].maisDistante);
+                    r.diametroInferior = std::max(r.diametroInferior, b.excentricidade);
+                }
+            }
+            k = fim;
+
+            // Limite superior pela origem mais central ainda não testada
+            int central = -1;
+            for (int i = 0; i < k; ++i)
+                if (amostras[i].pares == total - 1 && !reversaFeita[amostras[i].origem] &&
+                    (central == -1 || amostras[i].excentricidade < amostras[central].excentricidade))
+                    central = i;
+            if (central != -1)
+            {
+                reversaFeita[amostras[central].origem] = 1;
+                BuscaReversa b = buscaReversa(motorReverso, amostras[central].origem);
+                r.diametroInferior = std::max(r.diametroInferior, b.excentricidade);
+                if (b.alcancados == total - 1)
+                {
+                    long long limite = b.excentricidade + amostras[central].excentricidade;
+                    if (r.diametroSuperior < 0 || limite < r.diametroSuperior)
+                        r.diametroSuperior = limite;
+                }
+            }
+
+            // Caminho médio: estimador de razão com variância pelo método delta
+            long long somaTotal = 0, paresTotal = 0;
+            for (int i = 0; i < k; ++i)
+            {
+                somaTotal += amostras[i].soma;
+                paresTotal += amostras[i].pares;
+            }
+            if (paresTotal > 0)
+            {
+                double razao = (double)somaTotal / paresTotal, mediaPares = (double)paresTotal / k, residuos = 0;
+                for (int i = 0; i < k; ++i)
+                {
+                    double d = amostras[i].soma - razao * amostras[i].pares;
+                    residuos += d * d;
+                }
+                double variancia = k > 1 ? residuos / (k - 1) / (mediaPares * mediaPares) : 0.0;
+                r.caminhoMedio = {razao, meiaLargura(variancia, k, total)};
+            }
+
+            // Intermediação: total estimado = V · média das dependências
+            std::fill(soma.begin(), soma.end(), 0.0);
+            std::fill(quadrados.begin(), quadrados.end(), 0.0);
+            for (const auto &e : espacos)
+                for (int v = 1; v < n; ++v)
+                {
+                    soma[v] += e.acumulado[v];
+                    quadrados[v] += e.quadrados[v];
+                }
+            double maiorValor = 0, maiorErro = 0;
+            for (int v = 1; v < n; ++v)
+            {
+                double media = soma[v] / k;
+                double variancia = k > 1 ? (quadrados[v] - k * media * media) / (k - 1) : 0.0;
+                r.intermediacao[v] = {total * media, total * meiaLargura(variancia, k, total)};
+                maiorValor = std::max(maiorValor, r.intermediacao[v].valor);
+                maiorErro = std::max(maiorErro, r.intermediacao[v].erro);
+            }
+
+            if (k == total)
+                break;
+            double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - ini).count();
+            if (segundos >= config.tempoMaximo)
+                break;
+            bool caminhoOk = r.caminhoMedio.erro <= config.erroRelativo * r.caminhoMedio.valor;
+            bool intermediacaoOk = maiorErro <= config.erroRelativo * maiorValor;
+            bool diametroOk = !fortementeConexo ||
+                              (r.diametroSuperior >= 0 &&
+                               r.diametroSuperior - r.diametroInferior <= config.erroRelativo * r.diametroInferior);
+            if (k > 1 && caminhoOk && intermediacaoOk && diametroOk)
+                break;
+        }
+
+        r.origensAmostradas = k;
+        r.exato = k == total;
+        if (r.exato)
+        {
+            // Com todas as origens a maior distância vista é o diâmetro
+            r.diametroSuperior = r.diametroInferior;
+            r.caminhoMedio.erro = 0;
+            for (auto &e : r.intermediacao)
+                e.erro = 0;
+        }
+        return r;
+    }
+};
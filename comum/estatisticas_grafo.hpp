@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "componentes.hpp"
+#include "estatisticas_aproximadas.hpp"
+#include "grafo_csr.hpp"
+#include "intermediacao.hpp"
+#include "pool_threads.hpp"
+
+// Estatísticas de um grafo misto calculadas sob demanda, cada uma no máximo
+// uma vez. As dependências ficam explícitas nos acessores privados:
+//  - grauMinimo, grauMaximo          <- graus()
+//  - componentesConexas,
+//    componentesFortementeConexas    <- (buscas próprias, comum/componentes.hpp)
+//  - intermediacao, caminhoMedio,
+//    diametro                        <- caminhos(), a passada única de Brandes
+//                                       por origem (comum/intermediacao.hpp)
+// Pedir só a quantidade de componentes não dispara nenhum caminho mínimo, e
+// pedir o diâmetro depois da intermediação não refaz a passada.
+//
+// No modo aproximado (usarAproximacao) caminhos() amostra as origens em vez de
+// percorrer todas (comum/estatisticas_aproximadas.hpp); os acessores devolvem
+// as estimativas e estimativas() traz também os erros.
+class EstatisticasGrafo
+{
+private:
+    const GrafoCSR &g;
+    const GrafoCSR &reverso;
+    std::unique_ptr<PoolThreads> pool;
+    int qtdThreads;
+
+    bool temGraus = false, temComponentes = false, temFortes = false, temCaminhos = false;
+    std::vector<int> grausTotais;
+    int qtdComponentes = 0, qtdFortes = 0;
+    ResumoCaminhos resumo;
+    bool aproximar = false;
+    ConfiguracaoAproximacao configAproximacao;
+    ResumoAproximado estimado;
+
+    // Grau total: entradas de u no CSR mais os arcos que chegam em u
+    const std::vector<int> &graus()
+    {
+        if (!temGraus)
+        {
+            grausTotais.assign(g.qtdVertices + 1, 0);
+            for (int u = 1; u <= g.qtdVertices; ++u)
+                for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+                {
+                    grausTotais[u]++;
+                    if (g.ehArco[i])
+                        grausTotais[g.destino[i]]++;
+                }
+            temGraus = true;
+        }
+        return grausTotais;
+    }
+
+    PoolThreads &threads()
+    {
+        if (!pool)
+            pool = qtdThreads > 0 ? std::make_unique<PoolThreads>(qtdThreads) : std::make_unique<PoolThreads>();
+        return *pool;
+    }
+
+    const ResumoCaminhos &caminhos()
+    {
+        if (!temCaminhos)
+        {
+            if (aproximar)
+            {
+                estimado = EstimadorCaminhos(g, reverso).estimar(configAproximacao, threads());
+                resumo.intermediacao.resize(estimado.intermediacao.size());
+                for (std::size_t v = 0; v < estimado.intermediacao.size(); ++v)
+                    resumo.intermediacao[v] = estimado.intermediacao[v].valor;
+            }
+            else
+                resumo = IntermediacaoBrandes(g, reverso).calcular(threads());
+            temCaminhos = true;
+        }
+        return resumo;
+    }
+
+public:
+    // reverso deve ser transpor(grafo); os dois precisam viver mais que o objeto.
+    // threads: tamanho do pool das passadas paralelas (0 = todos os núcleos)
+    EstatisticasGrafo(const GrafoCSR &grafo, const GrafoCSR &transposto, int threads = 0)
+        : g(grafo), reverso(transposto), qtdThreads(threads) {}
+
+    // Passa a estimar caminho médio, diâmetro e intermediação por amostragem;
+    // deve ser chamado antes da primeira consulta a eles
+    void usarAproximacao(const ConfiguracaoAproximacao &config)
+    {
+        aproximar = true;
+        configAproximacao = config;
+    }
+
+    bool aproximado() const { return aproximar; }
+
+    // Estimativas com erros (modo aproximado)
+    const ResumoAproximado &estimativas()
+    {
+        caminhos();
+        return estimado;
+    }
+
+    int grauMinimo() { return *std::min_element(graus().begin() + 1, graus().end()); }
+    int grauMaximo() { return *std::max_element(graus().begin() + 1, graus().end()); }
+
+    // Componentes considerando só as arestas (ligações não direcionadas)
+    int componentesConexas()
+    {
+        if (!temComponentes)
+        {
+            qtdComponentes = contarComponentesFracas(g, [&](int i)
+                                                     { return !g.ehArco[i]; }, threads());
+            temComponentes = true;
+        }
+        return qtdComponentes;
+    }
+
+    // Componentes fortemente conexas do grafo misto (arestas nos dois sentidos)
+    int componentesFortementeConexas()
+    {
+        if (!temFortes)
+        {
+            std::vector<int> componente;
+            qtdFortes = componentesFortes(g, [](int)
+                                          { return true; }, componente);
+            temFortes = true;
+        }
+        return qtdFortes;
+    }
+
+    // Por vértice 1..V (índice 0 sem uso)
+    const std::vector<double> &intermediacao() { return caminhos().intermediacao; }
+
+    // Média das distâncias entre pares alcançáveis; -1 se não houver nenhum
+    double caminhoMedio()
+    {
+        const ResumoCaminhos &r = caminhos();
+        if (aproximar)
+            return estimado.caminhoMedio.valor;
+        if (r.paresAlcancaveis == 0)
+            return -1;
+        return static_cast<double>(r.somaDistancias) / r.paresAlcancaveis;
+    }
+
+    // No modo aproximado, o limite inferior (maior distância encontrada)
+    int diametro()
+    {
+        caminhos();
+        return (int)(aproximar ? estimado.diametroInferior : resumo.maiorDistancia);
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "grafo_csr.hpp"
+#include "motor_dijkstra.hpp"
+
+// Materializa sob demanda os caminhos de deslocamento (deadheading) entre
+// serviços. Em vez de uma matriz V² de antecessores, guarda só as árvores de
+// caminhos mínimos das origens efetivamente consultadas (V inteiros cada), até
+// maxArvores delas; as mais antigas são descartadas primeiro.
+class ExpansorCaminhos
+{
+private:
+    const GrafoCSR *g;
+    MotorDijkstra motor;
+    std::size_t maxArvores;
+    std::unordered_map<int, std::vector<int>> arvores;
+    std::deque<int> ordem;
+    std::vector<int> trecho;
+
+    const std::vector<int> &arvore(int origem)
+    {
+        auto it = arvores.find(origem);
+        if (it != arvores.end())
+            return it->second;
+
+        if (arvores.size() >= maxArvores)
+        {
+            arvores.erase(ordem.front());
+            ordem.pop_front();
+        }
+        motor.executar(origem);
+        const int *pred = motor.antecessores();
+        ordem.push_back(origem);
+        return arvores[origem] = std::vector<int>(pred, pred + g->qtdVertices + 1);
+    }
+
+public:
+    explicit ExpansorCaminhos(const GrafoCSR &grafo, std::size_t maxArvores = 64)
+        : g(&grafo), maxArvores(std::max<std::size_t>(1, maxArvores))
+    {
+        motor.preparar(grafo, INT_MAX, true);
+    }
+
+    // Acrescenta a saida os vértices do caminho mínimo de u até v, sem o próprio
+    // u (nada quando u == v). Devolve false se v não for alcançável a partir de u.
+    bool expandir(int u, int v, std::vector<int> &saida)
+    {
+        if (u == v)
+            return true;
+        const std::vector<int> &pred = arvore(u);
+        if (pred[v] == -1)
+            return false;
+        trecho.clear();
+        for (int x = v; x != u; x = pred[x])
+            trecho.push_back(x);
+        saida.insert(saida.end(), trecho.rbegin(), trecho.rend());
+        return true;
+    }
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "grafo_csr.hpp"
+#include "pool_threads.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FW_AVX2_DISPONIVEL 1
+#endif
+
+// Matriz quadrada de inteiros contígua, com linhas alinhadas em 64 bytes e
+// passo múltiplo do tamanho do bloco. Indexada como m[i][j].
+class MatrizAlinhada
+{
+private:
+    int n = 0, passoLinha = 0;
+    std::vector<int> memoria;
+    int *base = nullptr;
+
+public:
+    void alocar(int dimensao, int passo, int valor)
+    {
+        n = dimensao;
+        passoLinha = passo;
+        std::size_t total = (std::size_t)passo * passo;
+        memoria.assign(total + 16, valor);
+        std::uintptr_t p = reinterpret_cast<std::uintptr_t>(memoria.data());
+        base = memoria.data() + ((64 - p % 64) % 64) / sizeof(int);
+    }
+
+    int *operator[](int i) { return base + (std::size_t)i * passoLinha; }
+    const int *operator[](int i) const { return base + (std::size_t)i * passoLinha; }
+
+    int dimensao() const { return n; }
+    int passo() const { return passoLinha; }
+    bool vazia() const { return base == nullptr; }
+};
+
+// Floyd–Warshall em blocos (três fases por bloco k: diagonal, linha/coluna e
+// restantes). Cada bloco cabe na cache; na terceira fase os blocos são
+// independentes e processados em paralelo. O núcleo min-plus usa AVX2 quando o
+// processador suporta. Os pesos devem respeitar 2 * inf < INT_MAX. Só calcula
+// distâncias: o único uso é a tabela de vértices-chave de comum/apsp.hpp, e as
+// estatísticas da Parte 1 não passam por aqui.
+class FloydWarshallBlocado
+{
+private:
+    static constexpr int B = 64;
+
+    MatrizAlinhada &dist;
+
+    // C[i][j] = min(C[i][j], A[i][k] + Bk[k][j]) sobre um bloco, com k externo.
+    // Vale também quando A ou Bk coincidem com C (fases 1 e 2).
+    static void nucleoEscalar(int *c, const int *a, const int *b, int passo)
+    {
+        for (int k = 0; k < B; ++k)
+        {
+            const int *bk = b + (std::size_t)k * passo;
+            for (int i = 0; i < B; ++i)
+            {
+                int aik = a[(std::size_t)i * passo + k];
+                int *ci = c + (std::size_t)i * passo;
+                for (int j = 0; j < B; ++j)
+                    ci[j] = std::min(ci[j], aik + bk[j]);
+            }
+        }
+    }
+
+#ifdef FW_AVX2_DISPONIVEL
+    __attribute__((target("avx2"))) static void nucleoAVX2(int *c, const int *a, const int *b, int passo)
+    {
+        for (int k = 0; k < B; ++k)
+        {
+            const int *bk = b + (std::size_t)k * passo;
+            for (int i = 0; i < B; ++i)
+            {
+                __m256i aik = _mm256_set1_epi32(a[(std::size_t)i * passo + k]);
+                int *ci = c + (std::size_t)i * passo;
+                for (int j = 0; j < B; j += 8)
+                {
+                    __m256i s = _mm256_add_epi32(aik, _mm256_load_si256((const __m256i *)(bk + j)));
+                    __m256i atual = _mm256_load_si256((const __m256i *)(ci + j));
+                    _mm256_store_si256((__m256i *)(ci + j), _mm256_min_epi32(atual, s));
+                }
+            }
+        }
+    }
+#endif
+
+    void (*nucleo)(int *, const int *, const int *, int) = nucleoEscalar;
+
+    void atualizar(int bi, int bj, int bk)
+    {
+        int passo = dist.passo();
+        int *c = dist[bi * B] + bj * B;
+        const int *a = dist[bi * B] + bk * B;
+        const int *b = dist[bk * B] + bj * B;
+        nucleo(c, a, b, passo);
+    }
+
+public:
+    static int passoPara(int dimensao) { return (dimensao + B - 1) / B * B; }
+
+    explicit FloydWarshallBlocado(MatrizAlinhada &d) : dist(d)
+    {
+#ifdef FW_AVX2_DISPONIVEL
+        if (__builtin_cpu_supports("avx2"))
+            nucleo = nucleoAVX2;
+#endif
+    }
+
+    void executar(PoolThreads &pool)
+    {
+        int nb = dist.passo() / B;
+        for (int k = 0; k < nb; ++k)
+        {
+            // Fase 1: bloco diagonal
+            atualizar(k, k, k);
+
+            // Fase 2: blocos da linha e da coluna k
+            pool.paraCada(0, 2 * nb, [&](int t, int)
+                          {
+                              int outro = t / 2;
+                              if (outro == k)
+                                  return;
+                              if (t % 2 == 0)
+                                  atualizar(k, outro, k);
+                              else
+                                  atualizar(outro, k, k); });
+
+            // Fase 3: blocos restantes, independentes entre si
+            pool.paraCada(0, nb * nb, [&](int t, int)
+                          {
+                              int i = t / nb, j = t % nb;
+                              if (i != k && j != k)
+                                  atualizar(i, j, k); });
+        }
+    }
+};
+
+// Monta e resolve a matriz de distâncias do grafo (vértices 0..qtdVertices)
+inline void floydWarshallCSR(const GrafoCSR &g, int inf, MatrizAlinhada &dist, PoolThreads &pool)
+{
+    int n = g.qtdVertices + 1;
+    int passo = FloydWarshallBlocado::passoPara(n);
+    dist.alocar(n, passo, inf);
+
+    for (int i = 0; i < passo; ++i)
+        dist[i][i] = 0;
+
+    for (int u = 1; u <= g.qtdVertices; ++u)
+        for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+        {
+            int v = g.destino[i];
+            dist[u][v] = std::min(dist[u][v], g.peso[i]);
+        }
+
+    FloydWarshallBlocado(dist).executar(pool);
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "leitor_instancia.hpp"
+
+// Grafo misto em formato CSR (compressed sparse row): os vizinhos de u ficam em
+// destino/peso/ehArco no intervalo [inicio[u], inicio[u + 1]). Uma aresta aparece
+// nas listas das duas pontas com ehArco = 0; um arco só na origem, com ehArco = 1.
+// Vértices numerados de 1.
+struct GrafoCSR
+{
+    int qtdVertices = 0;
+    std::vector<int> inicio;
+    std::vector<int> destino;
+    std::vector<int> peso;
+    std::vector<unsigned char> ehArco;
+
+    int qtdEntradas() const { return (int)destino.size(); }
+    int grau(int u) const { return inicio[u + 1] - inicio[u]; }
+};
+
+// Monta o CSR a partir da instância lida: arestas entram nos dois sentidos, arcos em um.
+inline GrafoCSR construirCSR(const DadosInstancia &dados)
+{
+    GrafoCSR g;
+    g.qtdVertices = dados.qtdVertices;
+    g.inicio.assign(g.qtdVertices + 2, 0);
+
+    auto contar = [&](const std::vector<LigacaoLida> &ligacoes, bool dupla)
+    {
+        for (const auto &l : ligacoes)
+        {
+            g.inicio[l.origem + 1]++;
+            if (dupla)
+                g.inicio[l.destino + 1]++;
+        }
+    };
+    contar(dados.arestasRequeridas, true);
+    contar(dados.arcosRequeridos, false);
+    contar(dados.arestasOpcionais, true);
+    contar(dados.arcosOpcionais, false);
+
+    for (int u = 1; u <= g.qtdVertices + 1; ++u)
+        g.inicio[u] += g.inicio[u - 1];
+
+    g.destino.resize(g.inicio[g.qtdVertices + 1]);
+    g.peso.resize(g.destino.size());
+    g.ehArco.resize(g.destino.size());
+    std::vector<int> pos(g.inicio.begin(), g.inicio.end() - 1);
+
+    auto inserir = [&](const std::vector<LigacaoLida> &ligacoes, bool dupla)
+    {
+        for (const auto &l : ligacoes)
+        {
+            int i = pos[l.origem]++;
+            g.destino[i] = l.destino;
+            g.peso[i] = l.custo;
+            g.ehArco[i] = !dupla;
+            if (dupla)
+            {
+                i = pos[l.destino]++;
+                g.destino[i] = l.origem;
+                g.peso[i] = l.custo;
+                g.ehArco[i] = 0;
+            }
+        }
+    };
+    inserir(dados.arestasRequeridas, true);
+    inserir(dados.arcosRequeridos, false);
+    inserir(dados.arestasOpcionais, true);
+    inserir(dados.arcosOpcionais, false);
+
+    return g;
+}
+
+// Troca o peso das entradas origem -> destino do tipo indicado; uma aresta é
+// alterada nos dois sentidos. Devolve false se a ligação não existir.
+inline bool alterarPeso(GrafoCSR &g, int origem, int destino, bool arco, int peso)
+{
+    bool achou = false;
+    auto trocar = [&](int u, int v)
+    {
+        for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+            if (g.destino[i] == v && (bool)g.ehArco[i] == arco)
+            {
+                g.peso[i] = peso;
+                achou = true;
+            }
+    };
+    trocar(origem, destino);
+    if (!arco)
+        trocar(destino, origem);
+    return achou;
+}
+
+// Menor peso entre as entradas u -> v (INT_MAX se não houver nenhuma)
+inline int menorPeso(const GrafoCSR &g, int u, int v)
+{
+    int menor = INT_MAX;
+    for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+        if (g.destino[i] == v)
+            menor = std::min(menor, g.peso[i]);
+    return menor;
+}
+
+// Grafo transposto: cada entrada u -> v vira v -> u, mantendo peso e tipo.
+inline GrafoCSR transpor(const GrafoCSR &g)
+{
+    GrafoCSR t;
+    t.qtdVertices = g.qtdVertices;
+    t.inicio.assign(g.qtdVertices + 2, 0);
+    for (int v : g.destino)
+        t.inicio[v + 1]++;
+    for (int u = 1; u <= g.qtdVertices + 1; ++u)
+        t.inicio[u] += t.inicio[u - 1];
+
+    t.destino.resize(g.destino.size());
+    t.peso.resize(g.peso.size());
+    t.ehArco.resize(g.ehArco.size());
+    std::vector<int> pos(t.inicio.begin(), t.inicio.end() - 1);
+    for (int u = 1; u <= g.qtdVertices; ++u)
+        for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+        {
+            int j = pos[g.destino[i]]++;
+            t.destino[j] = u;
+            t.peso[j] = g.peso[i];
+            t.ehArco[j] = g.ehArco[i];
+        }
+    return t;
+}
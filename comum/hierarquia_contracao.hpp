@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "grafo_csr.hpp"
+#include "pool_threads.hpp"
+
+// Hierarquia de contração (CH) sobre o grafo misto. Os vértices são contraídos
+// um a um, em ordem de importância; ao contrair v, cada caminho u -> v -> w sem
+// caminho testemunha de custo menor ou igual vira um atalho u -> w. Depois
+// disso, toda distância é o mínimo sobre v de subida(s, v) + descida(v, t),
+// onde as duas buscas só andam para vértices contraídos mais tarde. Os espaços
+// de busca são pequenos, o que permite consultas ponto a ponto e tabelas
+// muitos-para-muitos sem matriz V².
+class HierarquiaContracao
+{
+public:
+    struct Ligacao
+    {
+        int v, peso;
+    };
+
+    // Área de rascunho de uma busca. As distâncias levam o carimbo da busca em
+    // que foram escritas, então reiniciar não percorre os V vértices.
+    class EspacoBusca
+    {
+    private:
+        std::vector<int> dist;
+        std::vector<unsigned> carimbo;
+        unsigned atual = 0;
+
+    public:
+        std::vector<std::pair<int, int>> heap;
+        std::vector<int> visitados;
+        std::vector<int> assentados; // vértices fechados sem poda, em ordem de distância
+
+        void preparar(int n)
+        {
+            if ((int)dist.size() != n)
+            {
+                dist.assign(n, INT_MAX);
+                carimbo.assign(n, 0);
+                atual = 0;
+            }
+        }
+
+        void reiniciar()
+        {
+            if (++atual == 0)
+            {
+                std::fill(carimbo.begin(), carimbo.end(), 0);
+                atual = 1;
+            }
+            heap.clear();
+            visitados.clear();
+            assentados.clear();
+        }
+
+        int valor(int v) const { return carimbo[v] == atual ? dist[v] : INT_MAX; }
+
+        void inserir(int v, int d)
+        {
+            if (carimbo[v] != atual)
+            {
+                carimbo[v] = atual;
+                visitados.push_back(v);
+            }
+            dist[v] = d;
+            heap.emplace_back(d, v);
+            std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>());
+        }
+
+        // Remove o menor da fila; devolve false se não houver entrada válida
+        bool extrair(int &v, int &d)
+        {
+            while (!heap.empty())
+            {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>());
+                auto [du, u] = heap.back();
+                heap.pop_back();
+                if (du == valor(u))
+                {
+                    v = u;
+                    d = du;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int menorNaFila() const { return heap.empty() ? INT_MAX : heap.front().first; }
+    };
+
+private:
+    int n = 0;
+    int atalhos = 0;
+    std::vector<int> nivel;
+    std::vector<int> inicioSubida, inicioDescida;
+    std::vector<Ligacao> subida;  // u -> w com nivel[w] > nivel[u], guardado em u
+    std::vector<Ligacao> descida; // w -> u com nivel[w] > nivel[u], guardado em u (busca reversa)
+
+    static void montarCSR(const std::vector<std::vector<Ligacao>> &listas, std::vector<int> &inicio,
+                          std::vector<Ligacao> &ligacoes)
+    {
+        inicio.assign(listas.size() + 1, 0);
+        for (std::size_t v = 0; v < listas.size(); ++v)
+            inicio[v + 1] = inicio[v] + (int)listas[v].size();
+        ligacoes.clear();
+        ligacoes.reserve(inicio.back());
+        for (const auto &l : listas)
+            ligacoes.insert(ligacoes.end(), l.begin(), l.end());
+    }
+
+    // Busca de subida completa a partir de origem (subida ou descida, conforme o
+    // CSR). Com poda por estagnação: se um vértice mais alto já alcançado chega
+    // a u por um caminho menor (ligações do CSR oposto), u não é expandido.
+    static void buscarAcima(int origem, const std::vector<int> &inicio, const std::vector<Ligacao> &ligacoes,
+                            const std::vector<int> &inicioOposto, const std::vector<Ligacao> &oposto, EspacoBusca &e)
+    {
+        e.reiniciar();
+        e.inserir(origem, 0);
+        int u, d;
+        while (e.extrair(u, d))
+        {
+            bool estagnado = false;
+            for (int i = inicioOposto[u]; i < inicioOposto[u + 1] && !estagnado; ++i)
+            {
+                int dw = e.valor(oposto[i].v);
+                estagnado = dw != INT_MAX && dw + oposto[i].peso < d;
+            }
+            if (estagnado)
+                continue;
+            e.assentados.push_back(u);
+            for (int i = inicio[u]; i < inicio[u + 1]; ++i)
+            {
+                const Ligacao &l = ligacoes[i];
+                if (d + l.peso < e.valor(l.v))
+                    e.inserir(l.v, d + l.peso);
+            }
+        }
+    }
+
+public:
+    // Constrói a hierarquia. limiteTestemunha limita os vértices visitados em
+    // cada busca testemunha; um limite menor acelera o pré-processamento ao custo
+    // de atalhos desnecessários (nunca de distâncias erradas).
+    void construir(const GrafoCSR &g, int limiteTestemunha = 500)
+    {
+        n = g.qtdVertices + 1;
+        atalhos = 0;
+        std::vector<std::vector<Ligacao>> saida(n), entrada(n);
+
+        auto ligar = [&](int u, int w, int peso)
+        {
+            for (auto &l : saida[u])
+                if (l.v == w)
+                {
+                    if (peso < l.peso)
+                    {
+                        l.peso = peso;
+                        for (auto &m : entrada[w])
+                            if (m.v == u)
+                                m.peso = peso;
+                    }
+                    return false;
+                }
+            saida[u].push_back({w, peso});
+            entrada[w].push_back({u, peso});
+            return true;
+        };
+        for (int u = 1; u < n; ++u)
+            for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+                if (g.destino[i] != u)
+                    ligar(u, g.destino[i], g.peso[i]);
+
+        std::vector<char> contraido(n, 0);
+        std::vector<int> vizinhosContraidos(n, 0);
+        EspacoBusca testemunha;
+        testemunha.preparar(n);
+        struct Atalho
+        {
+            int u, w, peso;
+        };
+        std::vector<Atalho> novos;
+
+        // Atalhos necessários para contrair v (em novos); v ainda não está contraído
+        auto simular = [&](int v)
+        {
+            novos.clear();
+            for (const auto &[u, a] : entrada[v])
+            {
+                int maximo = -1;
+                for (const auto &[w, b] : saida[v])
+                    if (w != u)
+                        maximo = std::max(maximo, a + b);
+                if (maximo < 0)
+                    continue;
+
+                testemunha.reiniciar();
+                testemunha.inserir(u, 0);
+                int x, d, visitados = 0;
+                while (visitados++ < limiteTestemunha && testemunha.extrair(x, d) && d <= maximo)
+                    for (const auto &[y, c] : saida[x])
+                        if (y != v && d + c < testemunha.valor(y))
+                            testemunha.inserir(y, d + c);
+
+                for (const auto &[w, b] : saida[v])
+                    if (w != u && testemunha.valor(w) > a + b)
+                        novos.push_back({u, w, a + b});
+            }
+        };
+
+        auto prioridade = [&](int v)
+        {
+            simular(v);
+            return 2 * ((int)novos.size() - (int)(entrada[v].size() + saida[v].size())) + vizinhosContraidos[v];
+        };
+
+        std::vector<int> prioridadeAtual(n);
+        std::vector<std::pair<int, int>> fila;
+        fila.reserve(n);
+        for (int v = 1; v < n; ++v)
+        {
+            prioridadeAtual[v] = prioridade(v);
+            fila.emplace_back(prioridadeAtual[v], v);
+        }
+        auto maior = std::greater<std::pair<int, int>>();
+        std::make_heap(fila.begin(), fila.end(), maior);
+
+        nivel.assign(n, 0);
+        std::vector<std::vector<Ligacao>> listasSubida(n), listasDescida(n);
+        int proximoNivel = 1;
+        std::vector<int> vizinhos;
+
+        while (!fila.empty())
+        {
+            std::pop_heap(fila.begin(), fila.end(), maior);
+            auto [p, v] = fila.back();
+            fila.pop_back();
+            if (contraido[v] || p != prioridadeAtual[v])
+                continue;
+
+            // Atualização preguiçosa: se a prioridade piorou, volta para a fila
+            int recalculada = prioridade(v);
+            if (!fila.empty() && recalculada > fila.front().first)
+            {
+                prioridadeAtual[v] = recalculada;
+                fila.emplace_back(recalculada, v);
+                std::push_heap(fila.begin(), fila.end(), maior);
+                continue;
+            }
+
+            // novos já contém os atalhos de v (calculados por prioridade(v))
+            std::vector<Atalho> atalhosV = novos;
+            contraido[v] = 1;
+            nivel[v] = proximoNivel++;
+            listasSubida[v] = saida[v];
+            listasDescida[v] = entrada[v];
+
+            vizinhos.clear();
+            for (const auto &[u, a] : entrada[v])
+            {
+                auto &l = saida[u];
+                l.erase(std::remove_if(l.begin(), l.end(), [&](const Ligacao &x)
+                                       { return x.v == v; }),
+                        l.end());
+                vizinhos.push_back(u);
+            }
+            for (const auto &[w, b] : saida[v])
+            {
+                auto &l = entrada[w];
+                l.erase(std::remove_if(l.begin(), l.end(), [&](const Ligacao &x)
+                                       { return x.v == v; }),
+                        l.end());
+                vizinhos.push_back(w);
+            }
+            saida[v].clear();
+            saida[v].shrink_to_fit();
+            entrada[v].clear();
+            entrada[v].shrink_to_fit();
+
+            for (const auto &a : atalhosV)
+                if (ligar(a.u, a.w, a.peso))
+                    ++atalhos;
+
+            std::sort(vizinhos.begin(), vizinhos.end());
+            vizinhos.erase(std::unique(vizinhos.begin(), vizinhos.end()), vizinhos.end());
+            // Só o termo de vizinhos contraídos muda de imediato; os atalhos
+            // são reavaliados quando o vértice chega ao topo da fila
+            for (int u : vizinhos)
+            {
+                ++vizinhosContraidos[u];
+                prioridadeAtual[u] += 1;
+                fila.emplace_back(prioridadeAtual[u], u);
+                std::push_heap(fila.begin(), fila.end(), maior);
+            }
+        }
+
+        montarCSR(listasSubida, inicioSubida, subida);
+        montarCSR(listasDescida, inicioDescida, descida);
+    }
+
+    int qtdAtalhos() const { return atalhos; }
+    int qtdVertices() const { return n - 1; }
+
+    // Distância de s a t (INT_MAX se não houver caminho), por busca bidirecional
+    int distancia(int s, int t, EspacoBusca &frente, EspacoBusca &tras) const
+    {
+        frente.preparar(n);
+        tras.preparar(n);
+        frente.reiniciar();
+        tras.reiniciar();
+        frente.inserir(s, 0);
+        tras.inserir(t, 0);
+        int melhor = s == t ? 0 : INT_MAX;
+
+        auto passo = [&](EspacoBusca &e, const EspacoBusca &outro, const std::vector<int> &inicio,
+                         const std::vector<Ligacao> &ligacoes)
+        {
+            int u, d;
+            if (!e.extrair(u, d))
+                return;
+            if (outro.valor(u) != INT_MAX)
+                melhor = std::min(melhor, d + outro.valor(u));
+            for (int i = inicio[u]; i < inicio[u + 1]; ++i)
+            {
+                const Ligacao &l = ligacoes[i];
+                if (d + l.peso < e.valor(l.v))
+                    e.inserir(l.v, d + l.peso);
+            }
+        };
+
+        while (true)
+        {
+            bool frenteAtiva = frente.menorNaFila() < melhor;
+            bool trasAtiva = tras.menorNaFila() < melhor;
+            if (!frenteAtiva && !trasAtiva)
+                break;
+            if (frenteAtiva)
+                passo(frente, tras, inicioSubida, subida);
+            if (trasAtiva)
+                passo(tras, frente, inicioDescida, descida);
+        }
+        return melhor;
+    }
+
+    // Tabela de distâncias origens x destinos pelo algoritmo de baldes: uma busca
+    // de descida por destino grava (destino, distância) em cada vértice
+    // alcançado; uma busca de subida por origem combina com esses baldes.
+    // saida(i, linha) recebe as distâncias de origens[i] a todos os destinos
+    // (inf quando não há caminho). As buscas rodam em paralelo no pool.
+    template <typename Saida>
+    void muitosParaMuitos(const std::vector<int> &origens, const std::vector<int> &destinos, int inf,
+                          PoolThreads &pool, Saida &&saida) const
+    {
+        struct EntradaBalde
+        {
+            int v, destino, dist;
+        };
+        int qtdThreads = pool.tamanho();
+        std::vector<EspacoBusca> espacos(qtdThreads);
+        std::vector<std::vector<EntradaBalde>> coletadas(qtdThreads);
+
+        pool.paraCada(0, (int)destinos.size(), [&](int j, int t)
+                      {
+                          EspacoBusca &e = espacos[t];
+                          e.preparar(n);
+                          buscarAcima(destinos[j], inicioDescida, descida, inicioSubida, subida, e);
+                          for (int v : e.assentados)
+                              coletadas[t].push_back({v, j, e.valor(v)}); });
+
+        // Baldes em CSR, indexados pelo vértice
+        std::vector<int> inicioBalde(n + 1, 0);
+        for (const auto &c : coletadas)
+            for (const auto &b : c)
+                ++inicioBalde[b.v + 1];
+        for (int v = 0; v < n; ++v)
+            inicioBalde[v + 1] += inicioBalde[v];
+        std::vector<std::pair<int, int>> baldes(inicioBalde[n]);
+        std::vector<int> posicao(inicioBalde.begin(), inicioBalde.end() - 1);
+        for (auto &c : coletadas)
+        {
+            for (const auto &b : c)
+                baldes[posicao[b.v]++] = {b.destino, b.dist};
+            std::vector<EntradaBalde>().swap(c);
+        }
+
+        std::vector<std::vector<int>> linhas(qtdThreads);
+        pool.paraCada(0, (int)origens.size(), [&](int i, int t)
+                      {
+                          EspacoBusca &e = espacos[t];
+                          std::vector<int> &linha = linhas[t];
+                          linha.assign(destinos.size(), inf);
+                          buscarAcima(origens[i], inicioSubida, subida, inicioDescida, descida, e);
+                          for (int v : e.assentados)
+                          {
+                              int dv = e.valor(v);
+                              for (int k = inicioBalde[v]; k < inicioBalde[v + 1]; ++k)
+                              {
+                                  auto [j, db] = baldes[k];
+                                  if (dv + db < linha[j])
+                                      linha[j] = dv + db;
+                              }
+                          }
+                          saida(i, linha.data()); });
+    }
+};
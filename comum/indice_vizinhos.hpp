@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "pool_threads.hpp"
+
+// Listas de candidatos mais próximos: para cada origem marcada, os até k
+// candidatos de menor distancia(origem, candidato), em ordem crescente de
+// (distância, candidato). Uma busca gulosa percorre a lista da posição atual
+// e só precisa varrer todos os candidatos quando nenhum dos k serve.
+// Construção em O(origens · candidatos) com nth_element, em paralelo se
+// houver pool.
+class IndiceVizinhos
+{
+private:
+    int k = 0;
+    std::vector<int> itens;   // k por origem
+    std::vector<int> tamanho; // quantos itens válidos cada origem tem
+
+public:
+    // Listas das origens 0..usada.size()-1 com usada[o] != 0; as demais ficam
+    // vazias. dist(o, c) devolve a distância da origem o ao candidato c.
+    template <typename Distancia>
+    void construir(const std::vector<char> &usada, const std::vector<int> &candidatos, int kMax,
+                   Distancia &&dist, PoolThreads *pool = nullptr)
+    {
+        int qtdOrigens = (int)usada.size();
+        k = std::min<int>(kMax, (int)candidatos.size());
+        itens.assign((std::size_t)qtdOrigens * k, -1);
+        tamanho.assign(qtdOrigens, 0);
+        if (k == 0)
+            return;
+
+        std::vector<std::vector<std::pair<int, int>>> rascunho(pool ? pool->tamanho() : 1);
+        auto preencher = [&](int o, int t)
+        {
+            if (!usada[o])
+                return;
+            auto &pares = rascunho[t];
+            pares.clear();
+            for (int c : candidatos)
+                pares.push_back({dist(o, c), c});
+            std::nth_element(pares.begin(), pares.begin() + (k - 1), pares.end());
+            std::sort(pares.begin(), pares.begin() + k);
+            for (int i = 0; i < k; ++i)
+                itens[(std::size_t)o * k + i] = pares[i].second;
+            tamanho[o] = k;
+        };
+        if (pool)
+            pool->paraCada(0, qtdOrigens, preencher);
+        else
+            for (int o = 0; o < qtdOrigens; ++o)
+                preencher(o, 0);
+    }
+
+    bool vazio() const { return tamanho.empty(); }
+    void limpar()
+    {
+        itens.clear();
+        tamanho.clear();
+    }
+
+    const int *inicio(int origem) const { return itens.data() + (std::size_t)origem * k; }
+    const int *fim(int origem) const { return inicio(origem) + tamanho[origem]; }
+};
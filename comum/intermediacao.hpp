@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "grafo_csr.hpp"
+#include "pool_threads.hpp"
+
+// Intermediação (betweenness) exata pelo algoritmo de Brandes sobre o grafo
+// misto ponderado: um Dijkstra por origem conta os caminhos mínimos (sigma) e
+// registra a ordem em que os vértices são fechados; depois as dependências são
+// acumuladas em ordem inversa. Os antecessores de w são as entradas u -> w do
+// grafo transposto com dist[u] + peso == dist[w], então nenhuma matriz ou lista
+// de antecessores é guardada. Empates entre caminhos mínimos dividem o crédito.
+// Custo O(V·E + V² log V); as origens são repartidas entre as threads do pool,
+// cada uma com seu acumulador, somados no final. Pesos devem ser positivos.
+//
+// Cada linha de distâncias de uma origem é consumida na mesma passada para a
+// soma das distâncias, a quantidade de pares alcançáveis e a maior distância
+// (caminho médio e diâmetro), sem materializar a matriz V².
+
+// Resultado da passada por todas as origens
+struct ResumoCaminhos
+{
+    std::vector<double> intermediacao; // por vértice 1..V; índice 0 sem uso
+    long long somaDistancias = 0;      // sobre os pares (s, t) alcançáveis, s != t
+    long long paresAlcancaveis = 0;
+    long long maiorDistancia = 0;
+};
+
+class IntermediacaoBrandes
+{
+private:
+    const GrafoCSR &g;
+    const GrafoCSR &reverso;
+
+public:
+    // Área de trabalho de uma thread. Depois de origem(s), ordem traz os
+    // vértices alcançados por s em distância crescente (o último é o mais
+    // distante) e soma/pares/maior acumulam os valores de todas as origens
+    // já processadas. quadrados, se alocado, acumula o quadrado da
+    // dependência de cada vértice por origem (para estimar variâncias).
+    struct Espaco
+    {
+        std::vector<long long> dist;
+        std::vector<double> sigma, delta, acumulado, quadrados;
+        std::vector<int> ordem;
+        long long soma = 0, pares = 0, maior = 0;
+        std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>,
+                            std::greater<std::pair<long long, int>>>
+            fila;
+
+        void preparar(int n, bool comQuadrados = false)
+        {
+            dist.assign(n, LLONG_MAX);
+            sigma.assign(n, 0.0);
+            delta.assign(n, 0.0);
+            acumulado.assign(n, 0.0);
+            quadrados.assign(comQuadrados ? n : 0, 0.0);
+        }
+    };
+
+    // reverso deve ser transpor(grafo)
+    IntermediacaoBrandes(const GrafoCSR &grafo, const GrafoCSR &transposto) : g(grafo), reverso(transposto) {}
+
+    // Processa uma origem: Dijkstra com contagem de caminhos e acúmulo das
+    // dependências em e
+    void origem(int s, Espaco &e) const
+    {
+        for (int v : e.ordem)
+        {
+            e.dist[v] = LLONG_MAX;
+            e.sigma[v] = 0.0;
+            e.delta[v] = 0.0;
+        }
+        e.ordem.clear();
+
+        e.dist[s] = 0;
+        e.sigma[s] = 1.0;
+        e.fila.push({0, s});
+        while (!e.fila.empty())
+        {
+            auto [d, u] = e.fila.top();
+            e.fila.pop();
+            if (d > e.dist[u])
+                continue;
+            e.ordem.push_back(u);
+            if (u != s)
+            {
+                e.soma += d;
+                e.pares++;
+                e.maior = std::max(e.maior, d);
+            }
+            for (int i = g.inicio[u]; i < g.inicio[u + 1]; ++i)
+            {
+                int w = g.destino[i];
+                long long nd = d + g.peso[i];
+                if (nd < e.dist[w])
+                {
+                    e.dist[w] = nd;
+                    e.sigma[w] = e.sigma[u];
+                    e.fila.push({nd, w});
+                }
+                else if (nd == e.dist[w])
+                    e.sigma[w] += e.sigma[u];
+            }
+        }
+
+        // ordem traz cada vértice fechado uma única vez, em distância crescente
+        for (int k = (int)e.ordem.size() - 1; k > 0; --k)
+        {
+            int w = e.ordem[k];
+            double fator = (1.0 + e.delta[w]) / e.sigma[w];
+            for (int i = reverso.inicio[w]; i < reverso.inicio[w + 1]; ++i)
+            {
+                int u = reverso.destino[i];
+                if (e.dist[u] != LLONG_MAX && e.dist[u] + reverso.peso[i] == e.dist[w])
+                    e.delta[u] += e.sigma[u] * fator;
+            }
+            e.acumulado[w] += e.delta[w];
+            if (!e.quadrados.empty())
+                e.quadrados[w] += e.delta[w] * e.delta[w];
+        }
+    }
+
+    // Intermediação de cada vértice, contando os pares ordenados (s, t) com
+    // s != t, e os totais de distância, numa única passada por origem
+    ResumoCaminhos calcular(PoolThreads &pool) const
+    {
+        int n = g.qtdVertices + 1;
+        std::vector<Espaco> espacos(pool.tamanho());
+        for (auto &e : espacos)
+            e.preparar(n);
+
+        pool.paraCada(1, n, [&](int s, int t)
+                      { origem(s, espacos[t]); });
+
+        ResumoCaminhos r;
+        r.intermediacao.assign(n, 0.0);
+        for (const auto &e : espacos)
+        {
+            for (int v = 0; v < n; ++v)
+                r.intermediacao[v] += e.acumulado[v];
+            r.somaDistancias += e.soma;
+            r.paresAlcancaveis += e.pares;
+            r.maiorDistancia = std::max(r.maiorDistancia, e.maior);
+        }
+        return r;
+    }
+};
@@ -0,0 +1,382 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arquivo_mapeado.hpp"
+
+// Leitor único do formato DI-NEARP usado pelos três programas.
+// O arquivo é mapeado em memória e percorrido uma única vez com um tokenizador
+// próprio (std::from_chars), sem std::string/std::stringstream por linha.
+
+struct NoLido
+{
+    int vertice, demanda, custoServico;
+};
+
+struct LigacaoLida
+{
+    int origem, destino, custo, demanda, custoServico;
+};
+
+struct ErroLeitura
+{
+    int linha;
+    std::string mensagem;
+};
+
+struct DadosInstancia
+{
+    std::string nome;
+    int valorOtimo = -1, qtdVeiculos = -1;
+    int capacidade = 0, deposito = 0, qtdVertices = 0;
+
+    // Quantidades declaradas no cabeçalho (-1 quando ausentes)
+    int qtdArestasDeclaradas = -1, qtdArcosDeclarados = -1;
+    int qtdNosReqDeclarados = -1, qtdArestasReqDeclaradas = -1, qtdArcosReqDeclarados = -1;
+
+    std::vector<NoLido> nosRequeridos;
+    std::vector<LigacaoLida> arestasRequeridas, arcosRequeridos;
+    std::vector<LigacaoLida> arestasOpcionais, arcosOpcionais;
+
+    std::vector<ErroLeitura> erros;
+};
+
+class LeitorInstancia
+{
+private:
+    enum Secao
+    {
+        NENHUMA,
+        REN,
+        REE,
+        REA,
+        EDGE,
+        ARC
+    };
+
+    DadosInstancia &dados;
+    int linhaAtual = 0;
+    int linhaSecao[6] = {0, 0, 0, 0, 0, 0};
+
+    static bool ehEspaco(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    static bool ehDigito(char c) { return c >= '0' && c <= '9'; }
+
+    static bool comecaCom(std::string_view s, std::string_view prefixo)
+    {
+        return s.size() >= prefixo.size() && s.compare(0, prefixo.size(), prefixo) == 0;
+    }
+
+    // Próximo token separado por espaços/tabulações dentro de [p, fim)
+    static std::string_view proximoToken(const char *&p, const char *fim)
+    {
+        while (p < fim && ehEspaco(*p))
+            ++p;
+        const char *ini = p;
+        while (p < fim && !ehEspaco(*p))
+            ++p;
+        return std::string_view(ini, p - ini);
+    }
+
+    static bool lerInteiro(const char *&p, const char *fim, int &valor)
+    {
+        std::string_view tok = proximoToken(p, fim);
+        if (tok.empty())
+            return false;
+        auto [ptr, ec] = std::from_chars(tok.data(), tok.data() + tok.size(), valor);
+        return ec == std::errc() && ptr == tok.data() + tok.size();
+    }
+
+    // Rótulo no formato <prefixo><número>, por exemplo N12, E3, NrE7
+    static bool rotuloValido(std::string_view tok, std::string_view prefixo)
+    {
+        if (!comecaCom(tok, prefixo) || tok.size() == prefixo.size())
+            return false;
+        for (size_t i = prefixo.size(); i < tok.size(); ++i)
+            if (!ehDigito(tok[i]))
+                return false;
+        return true;
+    }
+
+    void erro(const std::string &mensagem) { dados.erros.push_back({linhaAtual, mensagem}); }
+
+    bool verticeValido(int v, const char *campo)
+    {
+        if (v >= 1 && v <= dados.qtdVertices)
+            return true;
+        erro(std::string("vertice fora do intervalo em '") + campo + "': " + std::to_string(v));
+        return false;
+    }
+
+    void lerCabecalho(std::string_view chave, const char *p, const char *fim)
+    {
+        int *destino = nullptr;
+        if (chave == "Name:")
+        {
+            std::string_view nome = proximoToken(p, fim);
+            dados.nome.assign(nome.data(), nome.size());
+            return;
+        }
+        else if (chave == "Optimal")
+        {
+            proximoToken(p, fim);
+            destino = &dados.valorOtimo;
+        }
+        else if (chave == "#Vehicles:")
+            destino = &dados.qtdVeiculos;
+        else if (chave == "Capacity:")
+            destino = &dados.capacidade;
+        else if (chave == "Depot")
+        {
+            proximoToken(p, fim);
+            destino = &dados.deposito;
+        }
+        else if (chave == "#Nodes:")
+            destino = &dados.qtdVertices;
+        else if (chave == "#Edges:")
+            destino = &dados.qtdArestasDeclaradas;
+        else if (chave == "#Arcs:")
+            destino = &dados.qtdArcosDeclarados;
+        else if (chave == "#Required")
+        {
+            std::string_view tipo = proximoToken(p, fim);
+            if (tipo == "N:")
+                destino = &dados.qtdNosReqDeclarados;
+            else if (tipo == "E:")
+                destino = &dados.qtdArestasReqDeclaradas;
+            else if (tipo == "A:")
+                destino = &dados.qtdArcosReqDeclarados;
+        }
+
+        if (destino && !lerInteiro(p, fim, *destino))
+            erro("valor invalido no cabecalho '" + std::string(chave) + "'");
+    }
+
+    static bool ehCabecalho(std::string_view tok)
+    {
+        return tok == "Name:" || tok == "Optimal" || tok == "#Vehicles:" || tok == "Capacity:" ||
+               tok == "Depot" || tok == "#Nodes:" || tok == "#Edges:" || tok == "#Arcs:" ||
+               tok == "#Required";
+    }
+
+    static Secao secaoDoToken(std::string_view tok)
+    {
+        if (tok == "ReN.")
+            return REN;
+        if (tok == "ReE.")
+            return REE;
+        if (tok == "ReA.")
+            return REA;
+        if (tok == "EDGE" || tok == "EDGE.")
+            return EDGE;
+        if (tok == "ARC" || tok == "ARC.")
+            return ARC;
+        return NENHUMA;
+    }
+
+    // Verifica se a linha (cujo primeiro token é tok) é um registro da seção
+    static bool ehRegistro(Secao secao, std::string_view tok)
+    {
+        switch (secao)
+        {
+        case REN:
+            return rotuloValido(tok, "N");
+        case REE:
+            return rotuloValido(tok, "E");
+        case REA:
+            return rotuloValido(tok, "A");
+        case EDGE:
+            return rotuloValido(tok, "NrE") || rotuloValido(tok, "E");
+        case ARC:
+            return rotuloValido(tok, "NrA") || rotuloValido(tok, "A") || (!tok.empty() && ehDigito(tok[0]));
+        default:
+            return false;
+        }
+    }
+
+    void lerRegistro(Secao secao, std::string_view rotulo, const char *p, const char *fim)
+    {
+        if (dados.qtdVertices <= 0)
+        {
+            erro("registro antes da declaracao de #Nodes");
+            return;
+        }
+
+        if (secao == REN)
+        {
+            int vertice = 0, demanda, custo;
+            std::from_chars(rotulo.data() + 1, rotulo.data() + rotulo.size(), vertice);
+            if (!lerInteiro(p, fim, demanda) || !lerInteiro(p, fim, custo))
+            {
+                erro("registro ReN. incompleto");
+                return;
+            }
+            if (verticeValido(vertice, "ReN."))
+                dados.nosRequeridos.push_back({vertice, demanda, custo});
+            return;
+        }
+
+        // Na seção ARC o identificador NrA# é opcional (formato antigo só com números)
+        const char *q = p;
+        if (secao == ARC && ehDigito(rotulo[0]))
+            q = rotulo.data();
+
+        LigacaoLida l{0, 0, 0, 0, 0};
+        bool requerida = (secao == REE || secao == REA);
+        bool ok = lerInteiro(q, fim, l.origem) && lerInteiro(q, fim, l.destino) && lerInteiro(q, fim, l.custo);
+        if (ok && requerida)
+            ok = lerInteiro(q, fim, l.demanda) && lerInteiro(q, fim, l.custoServico);
+
+        static const char *nomes[] = {"", "ReN.", "ReE.", "ReA.", "EDGE", "ARC"};
+        if (!ok)
+        {
+            erro(std::string("registro ") + nomes[secao] + " incompleto");
+            return;
+        }
+        if (l.custo < 0 || l.demanda < 0)
+        {
+            erro(std::string("custo ou demanda negativos em ") + nomes[secao]);
+            return;
+        }
+        if (!verticeValido(l.origem, nomes[secao]) || !verticeValido(l.destino, nomes[secao]))
+            return;
+
+        switch (secao)
+        {
+        case REE:
+            dados.arestasRequeridas.push_back(l);
+            break;
+        case REA:
+            dados.arcosRequeridos.push_back(l);
+            break;
+        case EDGE:
+            dados.arestasOpcionais.push_back(l);
+            break;
+        default:
+            dados.arcosOpcionais.push_back(l);
+            break;
+        }
+    }
+
+    void reservar()
+    {
+        auto reserva = [](auto &v, int n)
+        {
+            if (n > 0)
+                v.reserve(n);
+        };
+        reserva(dados.nosRequeridos, dados.qtdNosReqDeclarados);
+        reserva(dados.arestasRequeridas, dados.qtdArestasReqDeclaradas);
+        reserva(dados.arcosRequeridos, dados.qtdArcosReqDeclarados);
+        if (dados.qtdArestasDeclaradas >= 0 && dados.qtdArestasReqDeclaradas >= 0)
+            reserva(dados.arestasOpcionais, dados.qtdArestasDeclaradas - dados.qtdArestasReqDeclaradas);
+        if (dados.qtdArcosDeclarados >= 0 && dados.qtdArcosReqDeclarados >= 0)
+            reserva(dados.arcosOpcionais, dados.qtdArcosDeclarados - dados.qtdArcosReqDeclarados);
+    }
+
+    void conferirQuantidade(Secao secao, const char *nome, size_t lidos, int declarados)
+    {
+        if (declarados < 0 || (int)lidos == declarados)
+            return;
+        linhaAtual = linhaSecao[secao];
+        erro(std::string("secao ") + nome + " com " + std::to_string(lidos) + " registros, cabecalho declara " +
+             std::to_string(declarados));
+    }
+
+public:
+    explicit LeitorInstancia(DadosInstancia &d) : dados(d) {}
+
+    void ler(const char *texto, size_t tamanho)
+    {
+        const char *p = texto;
+        const char *fimTexto = texto + tamanho;
+        Secao secao = NENHUMA;
+        bool reservado = false;
+
+        while (p < fimTexto)
+        {
+            const char *fimLinha = static_cast<const char *>(std::memchr(p, '\n', fimTexto - p));
+            if (!fimLinha)
+                fimLinha = fimTexto;
+            ++linhaAtual;
+
+            const char *cursor = p;
+            std::string_view tok = proximoToken(cursor, fimLinha);
+            p = fimLinha + 1;
+
+            if (tok.empty())
+                continue;
+
+            Secao nova = secaoDoToken(tok);
+            if (nova != NENHUMA)
+            {
+                if (!reservado)
+                {
+                    reservar();
+                    reservado = true;
+                }
+                secao = nova;
+                linhaSecao[secao] = linhaAtual;
+                continue;
+            }
+
+            if (secao != NENHUMA && ehRegistro(secao, tok))
+            {
+                lerRegistro(secao, tok, cursor, fimLinha);
+                continue;
+            }
+
+            // Qualquer outra linha encerra a seção corrente
+            secao = NENHUMA;
+            if (ehCabecalho(tok))
+                lerCabecalho(tok, cursor, fimLinha);
+        }
+
+        if (dados.qtdVertices <= 0)
+        {
+            linhaAtual = 0;
+            erro("cabecalho #Nodes ausente ou invalido");
+        }
+        else if (dados.deposito < 1 || dados.deposito > dados.qtdVertices)
+        {
+            linhaAtual = 0;
+            erro("deposito fora do intervalo: " + std::to_string(dados.deposito));
+        }
+
+        conferirQuantidade(REN, "ReN.", dados.nosRequeridos.size(), dados.qtdNosReqDeclarados);
+        conferirQuantidade(REE, "ReE.", dados.arestasRequeridas.size(), dados.qtdArestasReqDeclaradas);
+        conferirQuantidade(REA, "ReA.", dados.arcosRequeridos.size(), dados.qtdArcosReqDeclarados);
+        if (dados.qtdArestasDeclaradas >= 0 && dados.qtdArestasReqDeclaradas >= 0)
+            conferirQuantidade(EDGE, "EDGE", dados.arestasOpcionais.size(),
+                               dados.qtdArestasDeclaradas - dados.qtdArestasReqDeclaradas);
+        if (dados.qtdArcosDeclarados >= 0 && dados.qtdArcosReqDeclarados >= 0)
+            conferirQuantidade(ARC, "ARC", dados.arcosOpcionais.size(),
+                               dados.qtdArcosDeclarados - dados.qtdArcosReqDeclarados);
+    }
+};
+
+// Lê uma instância DI-NEARP. Retorna false se o arquivo não puder ser aberto ou
+// se houver seções mal formadas (detalhadas em dados.erros com o número da linha).
+inline bool lerInstancia(const std::string &caminho, DadosInstancia &dados)
+{
+    dados = DadosInstancia();
+    ArquivoMapeado arquivo;
+    if (!arquivo.abrir(caminho))
+    {
+        dados.erros.push_back({0, "nao foi possivel abrir o arquivo"});
+        return false;
+    }
+    LeitorInstancia(dados).ler(arquivo.dados(), arquivo.tamanho());
+    return dados.erros.empty();
+}
+
+inline void reportarErrosLeitura(std::ostream &out, const std::string &caminho, const DadosInstancia &dados)
+{
+    for (const auto &e : dados.erros)
+        out << caminho << ":" << e.linha << ": " << e.mensagem << "\n";
+}
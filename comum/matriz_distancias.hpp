@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Matriz de distâncias quadrada e contígua (linha por linha), indexada como
+// distancias[u][v]. Pode ser dona dos dados ou apenas apontar para memória
+// externa, por exemplo um snapshot mapeado em memória.
+class MatrizDistancias
+{
+private:
+    int n = 0;
+    std::vector<int> proprios;
+    const int *dados = nullptr;
+
+public:
+    void alocar(int dimensao, int valor)
+    {
+        n = dimensao;
+        proprios.assign((std::size_t)n * n, valor);
+        dados = proprios.data();
+    }
+
+    void apontar(const int *externo, int dimensao)
+    {
+        proprios.clear();
+        proprios.shrink_to_fit();
+        n = dimensao;
+        dados = externo;
+    }
+
+    // Passa a ser dona de uma cópia dos dados externos (para poder alterá-los)
+    void materializar()
+    {
+        if (dados == nullptr || dados == proprios.data())
+            return;
+        proprios.assign(dados, dados + (std::size_t)n * n);
+        dados = proprios.data();
+    }
+
+    const int *operator[](int u) const { return dados + (std::size_t)u * n; }
+
+    // Acesso para escrita; válido apenas quando a matriz é dona dos dados
+    int *linha(int u) { return proprios.data() + (std::size_t)u * n; }
+
+    int dimensao() const { return n; }
+    const int *bruto() const { return dados; }
+    bool vazia() const { return dados == nullptr; }
+};
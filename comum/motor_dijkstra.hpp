@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "grafo_csr.hpp"
+
+// Caminhos mínimos de uma origem sobre o CSR, com os buffers reaproveitados entre
+// chamadas (nenhuma alocação depois de preparar). Para custos inteiros pequenos
+// usa a fila de baldes de Dial, circular com maxPeso + 1 baldes; ela é escolhida
+// quando maxPeso * V cabe no orçamento, que limita a varredura de baldes vazios.
+// Caso contrário cai para um heap binário com remoção preguiçosa. Opcionalmente
+// registra o antecessor de cada vértice na árvore de caminhos mínimos.
+class MotorDijkstra
+{
+public:
+    static constexpr long long ORCAMENTO_BALDES = 1LL << 24;
+
+private:
+    const GrafoCSR *g = nullptr;
+    int inf = INT_MAX;
+    bool usarBaldes = false;
+    bool comPred = false;
+    std::vector<int> dist, pred;
+
+    // Baldes: listas duplamente ligadas intrusivas sobre os vértices
+    std::vector<int> cabeca, proximo, anterior;
+    std::vector<char> naFila;
+
+    std::vector<std::pair<int, int>> heap;
+
+    void inserir(int v, int balde)
+    {
+        anterior[v] = -1;
+        proximo[v] = cabeca[balde];
+        if (cabeca[balde] != -1)
+            anterior[cabeca[balde]] = v;
+        cabeca[balde] = v;
+        naFila[v] = 1;
+    }
+
+    void remover(int v, int balde)
+    {
+        if (anterior[v] != -1)
+            proximo[anterior[v]] = proximo[v];
+        else
+            cabeca[balde] = proximo[v];
+        if (proximo[v] != -1)
+            anterior[proximo[v]] = anterior[v];
+        naFila[v] = 0;
+    }
+
+    void executarBaldes(int origem)
+    {
+        int qtdBaldes = (int)cabeca.size();
+        std::fill(naFila.begin(), naFila.end(), 0);
+        inserir(origem, 0);
+        int pendentes = 1;
+        long long atual = 0;
+        while (pendentes > 0)
+        {
+            int balde = (int)(atual % qtdBaldes);
+            while (cabeca[balde] == -1)
+            {
+                ++atual;
+                balde = (int)(atual % qtdBaldes);
+            }
+            // Todos os pendentes estão em [atual, atual + maxPeso]: o balde contém só dist == atual
+            int u = cabeca[balde];
+            remover(u, balde);
+            --pendentes;
+            for (int i = g->inicio[u]; i < g->inicio[u + 1]; ++i)
+            {
+                int v = g->destino[i];
+                int nd = dist[u] + g->peso[i];
+                if (nd < dist[v])
+                {
+                    if (naFila[v])
+                        remover(v, dist[v] % qtdBaldes);
+                    else
+                        ++pendentes;
+                    dist[v] = nd;
+                    if (comPred)
+                        pred[v] = u;
+                    inserir(v, nd % qtdBaldes);
+                }
+            }
+        }
+    }
+
+    void executarHeap(int origem)
+    {
+        heap.clear();
+        heap.emplace_back(0, origem);
+        auto maior = std::greater<std::pair<int, int>>();
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), maior);
+            auto [custo, u] = heap.back();
+            heap.pop_back();
+            if (custo > dist[u])
+                continue;
+            for (int i = g->inicio[u]; i < g->inicio[u + 1]; ++i)
+            {
+                int v = g->destino[i];
+                if (dist[u] + g->peso[i] < dist[v])
+                {
+                    dist[v] = dist[u] + g->peso[i];
+                    if (comPred)
+                        pred[v] = u;
+                    heap.emplace_back(dist[v], v);
+                    std::push_heap(heap.begin(), heap.end(), maior);
+                }
+            }
+        }
+    }
+
+public:
+    // Associa o motor ao grafo e dimensiona os buffers; vértices não alcançados
+    // recebem infinito (e antecessor -1, com comPredecessores)
+    void preparar(const GrafoCSR &grafo, int infinito, bool comPredecessores = false,
+                  long long orcamento = ORCAMENTO_BALDES)
+    {
+        g = &grafo;
+        inf = infinito;
+        comPred = comPredecessores;
+        int n = grafo.qtdVertices + 1;
+        int maxPeso = 0;
+        for (int p : grafo.peso)
+            maxPeso = std::max(maxPeso, p);
+
+        dist.assign(n, inf);
+        pred.assign(comPred ? n : 0, -1);
+        usarBaldes = (long long)maxPeso * n <= orcamento;
+        if (usarBaldes)
+        {
+            cabeca.assign(maxPeso + 1, -1);
+            proximo.assign(n, -1);
+            anterior.assign(n, -1);
+            naFila.assign(n, 0);
+        }
+        else
+        {
+            heap.reserve(grafo.qtdEntradas() + 1);
+        }
+    }
+
+    bool preparado() const { return g != nullptr; }
+    bool usaBaldes() const { return usarBaldes; }
+
+    // Distâncias da origem a todos os vértices (0..V); válidas até a próxima chamada
+    const int *executar(int origem)
+    {
+        std::fill(dist.begin(), dist.end(), inf);
+        dist[origem] = 0;
+        if (comPred)
+        {
+            std::fill(pred.begin(), pred.end(), -1);
+            pred[origem] = origem;
+        }
+        if (usarBaldes)
+            executarBaldes(origem);
+        else
+            executarHeap(origem);
+        return dist.data();
+    }
+
+    // Antecessores da última execução (pred[origem] = origem); exige comPredecessores
+    const int *antecessores() const { return pred.data(); }
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "leitor_instancia.hpp"
+#include "matriz_distancias.hpp"
+
+// Vértices-chave de uma instância: o depósito e as extremidades de todos os
+// serviços (nós, arestas e arcos requeridos). As heurísticas só consultam
+// distâncias entre esses vértices.
+inline std::vector<int> verticesChave(const DadosInstancia &dados)
+{
+    std::vector<int> chaves;
+    chaves.reserve(1 + dados.nosRequeridos.size() +
+                   2 * (dados.arestasRequeridas.size() + dados.arcosRequeridos.size()));
+    chaves.push_back(dados.deposito);
+    for (const auto &n : dados.nosRequeridos)
+        chaves.push_back(n.vertice);
+    for (const auto *ligacoes : {&dados.arestasRequeridas, &dados.arcosRequeridos})
+        for (const auto &l : *ligacoes)
+        {
+            chaves.push_back(l.origem);
+            chaves.push_back(l.destino);
+        }
+    return chaves;
+}
+
+// Oráculo de distâncias restrito aos vértices-chave. Guarda uma tabela compacta
+// K x K (uma busca por chave) em vez da matriz (V+1)². Como as duas pontas de
+// cada aresta requerida são chaves, os dois sentidos de travessia estão na
+// tabela. Consultas entre vértices-chave custam dois acessos a vetor.
+class OraculoChaves
+{
+private:
+    std::vector<int> chaves;  // índice -> vértice, em ordem crescente
+    std::vector<int> indices; // vértice -> índice (-1 se não for chave)
+    MatrizDistancias tabela;
+
+public:
+    // Define o conjunto de chaves (repetições são descartadas); não calcula distâncias
+    void definir(int qtdVertices, std::vector<int> vertices)
+    {
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        chaves = std::move(vertices);
+        indices.assign(qtdVertices + 1, -1);
+        for (int k = 0; k < (int)chaves.size(); ++k)
+            indices[chaves[k]] = k;
+        tabela = MatrizDistancias();
+    }
+
+    void alocar(int inf) { tabela.alocar(qtdChaves(), inf); }
+
+    // Acesso para escrita à linha da chave k; válido depois de alocar
+    int *linha(int k) { return tabela.linha(k); }
+
+    // Copia para a linha k as colunas-chave de um vetor de distâncias por vértice
+    template <typename T>
+    void preencherLinha(int k, const T *distVertices)
+    {
+        int *destino = tabela.linha(k);
+        for (int j = 0; j < qtdChaves(); ++j)
+            destino[j] = distVertices[chaves[j]];
+    }
+
+    // Preenche a tabela inteira; busca(origem) devolve as distâncias de origem
+    // a todos os vértices (0..V).
+    template <typename Busca>
+    void calcular(int inf, Busca &&busca)
+    {
+        alocar(inf);
+        for (int k = 0; k < qtdChaves(); ++k)
+            preencherLinha(k, busca(chaves[k]));
+    }
+
+    // Usa uma tabela externa (por exemplo, mapeada de um snapshot) sem cópia
+    void apontar(int qtdVertices, std::vector<int> vertices, const int *externa)
+    {
+        definir(qtdVertices, std::move(vertices));
+        tabela.apontar(externa, qtdChaves());
+    }
+
+    // Copia a tabela externa (snapshot) para memória própria, antes de alterá-la
+    void materializar() { tabela.materializar(); }
+
+    int qtdChaves() const { return (int)chaves.size(); }
+    int chave(int v) const { return indices[v]; }
+    int vertice(int k) const { return chaves[k]; }
+    const std::vector<int> &vertices() const { return chaves; }
+    const MatrizDistancias &matriz() const { return tabela; }
+    bool calculado() const { return !tabela.vazia(); }
+
+    // Linha de uma chave indexada por vértice (o vértice consultado deve ser chave)
+    struct Linha
+    {
+        const int *valores;
+        const int *indices;
+        int operator[](int v) const { return valores[indices[v]]; }
+    };
+
+    const int *operator[](int k) const { return tabela[k]; }
+    Linha linhaDe(int u) const { return {tabela[indices[u]], indices.data()}; }
+    int entre(int u, int v) const { return tabela[indices[u]][indices[v]]; }
+
+    // Visão somente leitura da tabela pronta: ponteiros crus para a matriz
+    // plana e para o índice de chaves, copiada por valor para quem consulta.
+    // Não há sincronização; a tabela não pode mudar enquanto a visão estiver
+    // em uso.
+    struct Consulta
+    {
+        const int *valores = nullptr;
+        const int *indices = nullptr;
+        std::size_t qtd = 0;
+        int operator()(int u, int v) const { return valores[indices[u] * qtd + indices[v]]; }
+    };
+
+    Consulta consulta() const { return {tabela.bruto(), indices.data(), chaves.size()}; }
+};
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pool_threads.hpp"
+
+// Fila bloqueante com capacidade máxima. push bloqueia quando está cheia e pop
+// quando está vazia; depois de fechar(), pop devolve false ao esvaziar.
+template <typename T>
+class FilaLimitada
+{
+private:
+    std::deque<T> itens;
+    std::size_t capacidade;
+    bool fechada = false;
+    std::mutex mtx;
+    std::condition_variable temEspaco, temItem;
+
+public:
+    explicit FilaLimitada(std::size_t cap) : capacidade(std::max<std::size_t>(1, cap)) {}
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        temEspaco.wait(lock, [&]
+                       { return itens.size() < capacidade || fechada; });
+        itens.push_back(std::move(item));
+        temItem.notify_one();
+    }
+
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        temItem.wait(lock, [&]
+                     { return !itens.empty() || fechada; });
+        if (itens.empty())
+            return false;
+        item = std::move(itens.front());
+        itens.pop_front();
+        temEspaco.notify_one();
+        return true;
+    }
+
+    void fechar()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fechada = true;
+        temItem.notify_all();
+        temEspaco.notify_all();
+    }
+};
+
+// Limite de memória compartilhado pelas instâncias em andamento. Uma instância
+// maior que o limite inteiro ainda é aceita quando nada mais está reservado.
+class OrcamentoMemoria
+{
+private:
+    std::size_t limite, usado = 0;
+    std::mutex mtx;
+    std::condition_variable liberou;
+
+public:
+    explicit OrcamentoMemoria(std::size_t limiteBytes) : limite(limiteBytes) {}
+
+    void reservar(std::size_t bytes)
+    {
+        if (limite == 0)
+            return;
+        std::unique_lock<std::mutex> lock(mtx);
+        liberou.wait(lock, [&]
+                     { return usado == 0 || usado + bytes <= limite; });
+        usado += bytes;
+    }
+
+    void liberar(std::size_t bytes)
+    {
+        if (limite == 0)
+            return;
+        std::lock_guard<std::mutex> lock(mtx);
+        usado -= std::min(usado, bytes);
+        liberou.notify_all();
+    }
+};
+
+struct ConfiguracaoPipeline
+{
+    int threadsPreparo = 1;
+    int threadsResolucao = 1;
+    int threadsEscrita = 1;
+    std::size_t capacidadeFila = 2;
+    std::size_t memoriaMaxima = 0; // bytes; 0 = sem limite
+};
+
+// Converte o texto inteiro em um número; falha com texto vazio, caracteres
+// sobrando ou valor fora do alcance de long
+inline bool lerInteiro(const char *texto, long &valor)
+{
+    char *fim = nullptr;
+    errno = 0;
+    valor = std::strtol(texto, &fim, 10);
+    return fim != texto && *fim == '\0' && errno == 0;
+}
+
+// Mesma regra para números reais
+inline bool lerReal(const char *texto, double &valor)
+{
+    char *fim = nullptr;
+    errno = 0;
+    valor = std::strtod(texto, &fim);
+    return fim != texto && *fim == '\0' && errno == 0;
+}
+
+enum class ResultadoOpcao
+{
+    Aceita,
+    Desconhecida,
+    Invalida // reconhecida, mas sem valor ou com valor inválido (já informado em std::cerr)
+};
+
+// Reconhece as opções do pipeline em argv[i] (avançando i quando consome um valor)
+inline ResultadoOpcao lerOpcaoPipeline(int argc, char *argv[], int &i, ConfiguracaoPipeline &config)
+{
+    std::string opcao = argv[i];
+    if (opcao != "--preparo" && opcao != "--resolucao" && opcao != "--escrita" && opcao != "--fila" &&
+        opcao != "--memoria-mb")
+        return ResultadoOpcao::Desconhecida;
+    if (i + 1 >= argc)
+    {
+        std::cerr << "Falta o valor de " << opcao << "\n";
+        return ResultadoOpcao::Invalida;
+    }
+    long valor;
+    if (!lerInteiro(argv[i + 1], valor))
+    {
+        std::cerr << "Valor invalido para " << opcao << ": " << argv[i + 1] << "\n";
+        return ResultadoOpcao::Invalida;
+    }
+    valor = std::max(0L, valor);
+    if (opcao == "--preparo")
+        config.threadsPreparo = std::max(1L, valor);
+    else if (opcao == "--resolucao")
+        config.threadsResolucao = std::max(1L, valor);
+    else if (opcao == "--escrita")
+        config.threadsEscrita = std::max(1L, valor);
+    else if (opcao == "--fila")
+        config.capacidadeFila = std::max(1L, valor);
+    else
+        config.memoriaMaxima = (std::size_t)valor << 20;
+    ++i;
+    return ResultadoOpcao::Aceita;
+}
+
+// Pools de threads dos estágios de preparo e resolução. PoolThreads::paraCada
+// atende uma chamada por vez, então com um pool comum o pré-processamento de
+// uma instância esperaria a resolução da outra terminar o laço paralelo. Com
+// mais de uma entrada cada estágio recebe o seu pool, um quarto dos núcleos
+// para o preparo (bem mais curto que a resolução) e o resto para a
+// resolução; com uma entrada só não há o que sobrepor e o pool é um só.
+class PoolsPipeline
+{
+private:
+    std::unique_ptr<PoolThreads> poolResolucao, poolPreparo;
+
+public:
+    explicit PoolsPipeline(std::size_t qtdEntradas, int nucleos = (int)std::thread::hardware_concurrency())
+    {
+        nucleos = std::max(1, nucleos);
+        int nucleosPreparo = qtdEntradas > 1 && nucleos > 1 ? std::max(1, nucleos / 4) : 0;
+        poolResolucao = std::make_unique<PoolThreads>(nucleos - nucleosPreparo);
+        if (nucleosPreparo > 0)
+            poolPreparo = std::make_unique<PoolThreads>(nucleosPreparo);
+    }
+
+    PoolThreads &preparo() { return poolPreparo ? *poolPreparo : *poolResolucao; }
+    PoolThreads &resolucao() { return *poolResolucao; }
+};
+
+// Etapas aplicadas a cada instância. ler devolve nullptr para descartar a
+// entrada; memoria é a estimativa reservada antes do pré-processamento e
+// liberada depois da escrita.
+template <typename Item>
+struct EtapasPipeline
+{
+    std::function<std::unique_ptr<Item>(const std::string &)> ler;
+    std::function<std::size_t(const Item &)> memoria;
+    std::function<void(Item &)> preprocessar;
+    std::function<void(Item &)> resolver;
+    std::function<void(Item &)> escrever;
+};
+
+// Processa as entradas em três estágios sobrepostos ligados por filas limitadas:
+// preparo (leitura + pré-processamento), resolução e escrita. Enquanto a
+// instância N é resolvida, N+1 já está sendo preparada e N-1 gravada.
+template <typename Item>
+void executarPipeline(const std::vector<std::string> &entradas, const ConfiguracaoPipeline &config,
+                      const EtapasPipeline<Item> &etapas)
+{
+    struct Tarefa
+    {
+        std::unique_ptr<Item> item;
+        std::size_t memoria = 0;
+    };
+
+    FilaLimitada<Tarefa> preparadas(config.capacidadeFila), resolvidas(config.capacidadeFila);
+    OrcamentoMemoria orcamento(config.memoriaMaxima);
+    std::atomic<std::size_t> proxima{0};
+    std::atomic<int> preparoAtivo{config.threadsPreparo}, resolucaoAtiva{config.threadsResolucao};
+
+    auto preparo = [&]
+    {
+        for (std::size_t i = proxima++; i < entradas.size(); i = proxima++)
+        {
+            Tarefa t;
+            t.item = etapas.ler(entradas[i]);
+            if (!t.item)
+                continue;
+            t.memoria = etapas.memoria ? etapas.memoria(*t.item) : 0;
+            orcamento.reservar(t.memoria);
+            if (etapas.preprocessar)
+                etapas.preprocessar(*t.item);
+            preparadas.push(std::move(t));
+        }
+        if (--preparoAtivo == 0)
+            preparadas.fechar();
+    };
+
+    auto resolucao = [&]
+    {
+        Tarefa t;
+        while (preparadas.pop(t))
+        {
+            etapas.resolver(*t.item);
+            resolvidas.push(std::move(t));
+        }
+        if (--resolucaoAtiva == 0)
+            resolvidas.fechar();
+    };
+
+    auto escrita = [&]
+    {
+        Tarefa t;
+        while (resolvidas.pop(t))
+        {
+            etapas.escrever(*t.item);
+            t.item.reset();
+            orcamento.liberar(t.memoria);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < config.threadsPreparo; ++i)
+        threads.emplace_back(preparo);
+    for (int i = 0; i < config.threadsResolucao; ++i)
+        threads.emplace_back(resolucao);
+    for (int i = 0; i < config.threadsEscrita; ++i)
+        threads.emplace_back(escrita);
+    for (auto &t : threads)
+        t.join();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Conjunto fixo de threads para laços paralelos. paraCada distribui os índices
+// [inicio, fim) dinamicamente entre as threads (a thread chamadora também
+// trabalha) e só retorna quando todos foram processados. A função recebe o
+// índice e o id da thread (0 .. tamanho()-1), para uso de buffers por thread.
+class PoolThreads
+{
+private:
+    std::vector<std::thread> trabalhadores;
+    std::mutex mtx, mtxChamada;
+    std::condition_variable cvTrabalho, cvFim;
+    const std::function<void(int, int)> *tarefa = nullptr;
+    std::atomic<int> proximo{0};
+    int limite = 0;
+    int pendentes = 0;
+    uint64_t geracao = 0;
+    bool encerrar = false;
+
+    void executar(int idThread)
+    {
+        for (int i = proximo++; i < limite; i = proximo++)
+            (*tarefa)(i, idThread);
+    }
+
+    void laco(int idThread)
+    {
+        uint64_t vista = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cvTrabalho.wait(lock, [&]
+                                { return encerrar || geracao != vista; });
+                if (encerrar)
+                    return;
+                vista = geracao;
+            }
+            executar(idThread);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (--pendentes == 0)
+                    cvFim.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit PoolThreads(int qtdThreads = (int)std::thread::hardware_concurrency())
+    {
+        qtdThreads = std::max(1, qtdThreads);
+        for (int t = 1; t < qtdThreads; ++t)
+            trabalhadores.emplace_back([this, t]
+                                       { laco(t); });
+    }
+
+    PoolThreads(const PoolThreads &) = delete;
+    PoolThreads &operator=(const PoolThreads &) = delete;
+
+    ~PoolThreads()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            encerrar = true;
+        }
+        cvTrabalho.notify_all();
+        for (auto &t : trabalhadores)
+            t.join();
+    }
+
+    int tamanho() const { return (int)trabalhadores.size() + 1; }
+
+    void paraCada(int inicio, int fim, const std::function<void(int, int)> &f)
+    {
+        if (inicio >= fim)
+            return;
+        std::lock_guard<std::mutex> chamada(mtxChamada);
+        if (trabalhadores.empty() || fim - inicio == 1)
+        {
+            for (int i = inicio; i < fim; ++i)
+                f(i, 0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tarefa = &f;
+            proximo = inicio;
+            limite = fim;
+            pendentes = (int)trabalhadores.size();
+            ++geracao;
+        }
+        cvTrabalho.notify_all();
+        executar(0);
+        std::unique_lock<std::mutex> lock(mtx);
+        cvFim.wait(lock, [&]
+                   { return pendentes == 0; });
+        tarefa = nullptr;
+    }
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <climits>
+#include <vector>
+
+#include "pool_threads.hpp"
+
+// Portfólio de heurísticas independentes executado no pool, uma por tarefa.
+// As tarefas 0..obrigatorias-1 sempre rodam; as demais (variantes
+// aleatorizadas, por exemplo) só começam enquanto o prazo não venceu. Quem já
+// começou termina, então o prazo é ultrapassado no máximo pela duração de uma
+// tarefa. tarefa(i, idThread) devolve o custo da solução i (LLONG_MAX se não
+// produziu nenhuma); o resultado é o índice de menor custo entre as que
+// rodaram, com empate para o menor índice, ou -1.
+
+struct ConfiguracaoPortfolio
+{
+    double tempoMaximo = 1.0;    // segundos
+    int variantesAleatorias = 32;
+};
+
+template <typename Tarefa>
+int executarPortfolio(PoolThreads &pool, int obrigatorias, int total, double tempoMaximo, Tarefa &&tarefa)
+{
+    auto prazo = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                        std::chrono::duration<double>(tempoMaximo));
+    std::vector<long long> custos(total, LLONG_MAX);
+    pool.paraCada(0, total, [&](int i, int t)
+                  {
+                      if (i >= obrigatorias && std::chrono::steady_clock::now() >= prazo)
+                          return;
+                      custos[i] = tarefa(i, t); });
+
+    int melhor = -1;
+    for (int i = 0; i < total; ++i)
+        if (custos[i] != LLONG_MAX && (melhor == -1 || custos[i] < custos[melhor]))
+            melhor = i;
+    return melhor;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "grafo_csr.hpp"
+#include "leitor_instancia.hpp"
+
+// Renumeração dos vértices por Reverse Cuthill–McKee a partir do depósito.
+// Vértices vizinhos passam a ter ids próximos, de modo que linhas da matriz de
+// distâncias e listas do CSR acessadas juntas caem em linhas de cache vizinhas.
+// novo[v] é o id renumerado do vértice original v; original[n] faz o inverso.
+struct Reordenacao
+{
+    std::vector<int> novo;
+    std::vector<int> original;
+
+    bool ativa() const { return !original.empty(); }
+    int paraOriginal(int v) const { return ativa() && v > 0 ? original[v] : v; }
+    int paraNovo(int v) const { return ativa() && v > 0 ? novo[v] : v; }
+
+    static Reordenacao aPartirDoOriginal(std::vector<int> orig)
+    {
+        Reordenacao r;
+        if (orig.empty())
+            return r;
+        r.original = std::move(orig);
+        r.novo.assign(r.original.size(), 0);
+        for (size_t i = 1; i < r.original.size(); ++i)
+            r.novo[r.original[i]] = (int)i;
+        return r;
+    }
+};
+
+inline Reordenacao calcularOrdemRCM(const GrafoCSR &g, int raiz)
+{
+    int n = g.qtdVertices;
+    const GrafoCSR t = transpor(g);
+
+    // Vizinhança não direcionada: entradas do grafo e do transposto
+    std::vector<int> grau(n + 1, 0);
+    for (int u = 1; u <= n; ++u)
+        grau[u] = g.grau(u) + t.grau(u);
+
+    std::vector<int> ordem;
+    ordem.reserve(n);
+    std::vector<char> visitado(n + 1, 0);
+    std::vector<int> vizinhos;
+
+    auto bfs = [&](int s)
+    {
+        size_t cabeca = ordem.size();
+        visitado[s] = 1;
+        ordem.push_back(s);
+        while (cabeca < ordem.size())
+        {
+            int u = ordem[cabeca++];
+            vizinhos.clear();
+            for (const GrafoCSR *h : {&g, &t})
+                for (int i = h->inicio[u]; i < h->inicio[u + 1]; ++i)
+                    if (!visitado[h->destino[i]])
+                    {
+                        visitado[h->destino[i]] = 1;
+                        vizinhos.push_back(h->destino[i]);
+                    }
+            std::sort(vizinhos.begin(), vizinhos.end(), [&](int a, int b)
+                      { return grau[a] != grau[b] ? grau[a] < grau[b] : a < b; });
+            ordem.insert(ordem.end(), vizinhos.begin(), vizinhos.end());
+        }
+    };
+
+    if (raiz >= 1 && raiz <= n)
+        bfs(raiz);
+
+    // Componentes não alcançadas a partir do depósito começam pelo vértice de menor grau
+    std::vector<int> restantes;
+    for (int v = 1; v <= n; ++v)
+        if (!visitado[v])
+            restantes.push_back(v);
+    std::stable_sort(restantes.begin(), restantes.end(), [&](int a, int b)
+                     { return grau[a] < grau[b]; });
+    for (int v : restantes)
+        if (!visitado[v])
+            bfs(v);
+
+    std::reverse(ordem.begin(), ordem.end());
+
+    Reordenacao r;
+    r.novo.assign(n + 1, 0);
+    r.original.assign(n + 1, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        r.original[i + 1] = ordem[i];
+        r.novo[ordem[i]] = i + 1;
+    }
+    return r;
+}
+
+// Renumera depósito, serviços e ligações da instância segundo a ordem RCM e
+// devolve a permutação usada para traduzir os ids de volta na saída.
+inline Reordenacao reordenarInstancia(DadosInstancia &dados)
+{
+    Reordenacao r = calcularOrdemRCM(construirCSR(dados), dados.deposito);
+
+    dados.deposito = r.novo[dados.deposito];
+    for (auto &n : dados.nosRequeridos)
+        n.vertice = r.novo[n.vertice];
+    for (auto *ligacoes : {&dados.arestasRequeridas, &dados.arcosRequeridos, &dados.arestasOpcionais, &dados.arcosOpcionais})
+        for (auto &l : *ligacoes)
+        {
+            l.origem = r.novo[l.origem];
+            l.destino = r.novo[l.destino];
+        }
+    return r;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+
+// Representação compacta de soluções de roteamento em arcos. Os atributos dos
+// serviços ficam em arrays por id (TabelaServicos) e cada rota é só um array
+// contíguo de passos: id do serviço com a orientação no bit menos
+// significativo. O depósito não é guardado; ele abre e fecha toda rota.
+// SolucaoRotas mantém por rota a carga e o custo (serviços + deslocamentos)
+// e, por serviço, a rota e a posição em que ele está: checar capacidade é
+// O(1) e a posição de um serviço não exige busca.
+
+struct TabelaServicos
+{
+    // Índice 0 sem uso
+    std::vector<int> inicio, fim, demanda, custo;
+    std::vector<char> reversivel; // aresta requerida: pode ser atendida de fim para inicio
+
+    int qtd() const { return (int)demanda.size() - 1; }
+
+    void redimensionar(int qtdServicos)
+    {
+        inicio.assign(qtdServicos + 1, 0);
+        fim.assign(qtdServicos + 1, 0);
+        demanda.assign(qtdServicos + 1, 0);
+        custo.assign(qtdServicos + 1, 0);
+        reversivel.assign(qtdServicos + 1, 0);
+    }
+};
+
+inline int passoDe(int id, bool invertido) { return id << 1 | (int)invertido; }
+inline int servicoDo(int passo) { return passo >> 1; }
+inline bool invertidoNo(int passo) { return passo & 1; }
+inline int inverterPasso(int passo) { return passo ^ 1; }
+
+class SolucaoRotas
+{
+private:
+    const TabelaServicos *tabela = nullptr;
+    int deposito = 0;
+
+public:
+    std::vector<std::vector<int>> passos; // passos de cada rota, sem o depósito
+    std::vector<int> carga;               // demanda atendida por rota
+    std::vector<long long> custo;         // serviços + deslocamentos por rota
+    std::vector<int> rotaDe, posicaoDe;   // por id de serviço; -1 fora da solução
+
+    SolucaoRotas() = default;
+    SolucaoRotas(const TabelaServicos &servicos, int verticeDeposito)
+        : tabela(&servicos), deposito(verticeDeposito), rotaDe(servicos.qtd() + 1, -1),
+          posicaoDe(servicos.qtd() + 1, -1) {}
+
+    const TabelaServicos &servicos() const { return *tabela; }
+    int qtdRotas() const { return (int)passos.size(); }
+    bool vazia() const { return passos.empty(); }
+
+    int entrada(int passo) const
+    {
+        int id = servicoDo(passo);
+        return invertidoNo(passo) ? tabela->fim[id] : tabela->inicio[id];
+    }
+    int saida(int passo) const
+    {
+        int id = servicoDo(passo);
+        return invertidoNo(passo) ? tabela->inicio[id] : tabela->fim[id];
+    }
+
+    // Vértice de entrada/saída da posição p da rota r; p = -1 e p = tamanho
+    // são o depósito
+    int entradaEm(int r, int p) const
+    {
+        return p < 0 || p >= (int)passos[r].size() ? deposito : entrada(passos[r][p]);
+    }
+    int saidaEm(int r, int p) const
+    {
+        return p < 0 || p >= (int)passos[r].size() ? deposito : saida(passos[r][p]);
+    }
+
+    template <typename Distancia>
+    long long custoDe(const std::vector<int> &rota, Distancia &&dist) const
+    {
+        long long total = 0;
+        int atual = deposito;
+        for (int passo : rota)
+        {
+            total += dist(atual, entrada(passo)) + (long long)tabela->custo[servicoDo(passo)];
+            atual = saida(passo);
+        }
+        return total + dist(atual, deposito);
+    }
+
+    // Refaz carga, custo e índices da rota r depois de alterar seus passos
+    template <typename Distancia>
+    void atualizarRota(int r, Distancia &&dist)
+    {
+        int total = 0;
+        for (int p = 0; p < (int)passos[r].size(); ++p)
+        {
+            int id = servicoDo(passos[r][p]);
+            total += tabela->demanda[id];
+            rotaDe[id] = r;
+            posicaoDe[id] = p;
+        }
+        carga[r] = total;
+        custo[r] = custoDe(passos[r], dist);
+    }
+
+    // Só os índices das posições de..ate da rota r (movimentos que já
+    // ajustaram carga e custo por delta)
+    void reindexar(int r, int de, int ate)
+    {
+        for (int p = de; p <= ate; ++p)
+        {
+            rotaDe[servicoDo(passos[r][p])] = r;
+            posicaoDe[servicoDo(passos[r][p])] = p;
+        }
+    }
+
+    // Tira a rota r da solução; as seguintes descem uma posição
+    void removerRota(int r)
+    {
+        for (int passo : passos[r])
+            rotaDe[servicoDo(passo)] = posicaoDe[servicoDo(passo)] = -1;
+        passos.erase(passos.begin() + r);
+        carga.erase(carga.begin() + r);
+        custo.erase(custo.begin() + r);
+        for (int q = r; q < qtdRotas(); ++q)
+            for (int passo : passos[q])
+                rotaDe[servicoDo(passo)] = q;
+    }
+
+    template <typename Distancia>
+    int adicionarRota(std::vector<int> novos, Distancia &&dist)
+    {
+        passos.push_back(std::move(novos));
+        carga.push_back(0);
+        custo.push_back(0);
+        atualizarRota(qtdRotas() - 1, dist);
+        return qtdRotas() - 1;
+    }
+
+    long long custoTotal() const
+    {
+        long long total = 0;
+        for (long long c : custo)
+            total += c;
+        return total;
+    }
+
+    // Soma só dos custos de serviço
+    long long custoServicos() const
+    {
+        long long total = 0;
+        for (const auto &rota : passos)
+            for (int passo : rota)
+                total += tabela->custo[servicoDo(passo)];
+        return total;
+    }
+};
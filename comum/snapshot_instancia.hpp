@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "arquivo_mapeado.hpp"
+#include "grafo_csr.hpp"
+#include "leitor_instancia.hpp"
+#include "oraculo_chaves.hpp"
+
+// Snapshot binário pré-compilado de uma instância: cabeçalho, serviços, grafo CSR
+// e tabela de distâncias entre os vértices-chave (depósito e extremidades dos
+// serviços). É lido com mmap e a tabela é usada diretamente das páginas
+// mapeadas, sem reprocessar o .dat nem rodar Dijkstra.
+//
+// Layout: CabecalhoSnapshot seguido das seções, cada uma alinhada em 64 bytes.
+// Se a instância foi renumerada (RCM), a seção de permutação guarda o id
+// original de cada vértice; caso contrário ela fica vazia.
+// Os inteiros são gravados na ordem de bytes da máquina que compilou o snapshot.
+
+constexpr char MAGICA_SNAPSHOT[8] = {'D', 'I', 'N', 'E', 'A', 'R', 'P', 'S'};
+constexpr uint32_t VERSAO_SNAPSHOT = 4;
+constexpr uint64_t ALINHAMENTO_SNAPSHOT = 64;
+
+enum SecaoSnapshotId
+{
+    SNAP_NOS,
+    SNAP_ARESTAS_REQ,
+    SNAP_ARCOS_REQ,
+    SNAP_ARESTAS_OPC,
+    SNAP_ARCOS_OPC,
+    SNAP_CSR_INICIO,
+    SNAP_CSR_DESTINO,
+    SNAP_CSR_PESO,
+    SNAP_CSR_ARCO,
+    SNAP_MATRIZ,
+    SNAP_CHAVES,
+    SNAP_PERMUTACAO,
+    SNAP_QTD_SECOES
+};
+
+struct SecaoSnapshot
+{
+    uint64_t deslocamento, bytes;
+};
+
+struct CabecalhoSnapshot
+{
+    char magica[8];
+    uint32_t versao;
+    uint32_t tamanhoCabecalho;
+    char nome[64];
+    int32_t valorOtimo, qtdVeiculos, capacidade, deposito, qtdVertices;
+    int32_t dimensaoMatriz;
+    SecaoSnapshot secoes[SNAP_QTD_SECOES];
+};
+
+inline bool salvarSnapshot(const std::string &caminho, const DadosInstancia &dados, const GrafoCSR &grafo,
+                           const OraculoChaves &oraculo, const std::vector<int> &permutacao = {})
+{
+    CabecalhoSnapshot cab;
+    std::memset(&cab, 0, sizeof(cab));
+    std::memcpy(cab.magica, MAGICA_SNAPSHOT, sizeof(cab.magica));
+    cab.versao = VERSAO_SNAPSHOT;
+    cab.tamanhoCabecalho = sizeof(CabecalhoSnapshot);
+    std::strncpy(cab.nome, dados.nome.c_str(), sizeof(cab.nome) - 1);
+    cab.valorOtimo = dados.valorOtimo;
+    cab.qtdVeiculos = dados.qtdVeiculos;
+    cab.capacidade = dados.capacidade;
+    cab.deposito = dados.deposito;
+    cab.qtdVertices = dados.qtdVertices;
+    cab.dimensaoMatriz = oraculo.qtdChaves();
+
+    const void *origens[SNAP_QTD_SECOES] = {
+        dados.nosRequeridos.data(), dados.arestasRequeridas.data(), dados.arcosRequeridos.data(),
+        dados.arestasOpcionais.data(), dados.arcosOpcionais.data(), grafo.inicio.data(),
+        grafo.destino.data(), grafo.peso.data(), grafo.ehArco.data(), oraculo.matriz().bruto(),
+        oraculo.vertices().data(), permutacao.data()};
+    uint64_t tamanhos[SNAP_QTD_SECOES] = {
+        dados.nosRequeridos.size() * sizeof(NoLido),
+        dados.arestasRequeridas.size() * sizeof(LigacaoLida),
+        dados.arcosRequeridos.size() * sizeof(LigacaoLida),
+        dados.arestasOpcionais.size() * sizeof(LigacaoLida),
+        dados.arcosOpcionais.size() * sizeof(LigacaoLida),
+        grafo.inicio.size() * sizeof(int),
+        grafo.destino.size() * sizeof(int),
+        grafo.peso.size() * sizeof(int),
+        grafo.ehArco.size(),
+        (uint64_t)oraculo.qtdChaves() * oraculo.qtdChaves() * sizeof(int),
+        oraculo.vertices().size() * sizeof(int),
+        permutacao.size() * sizeof(int)};
+
+    uint64_t pos = sizeof(CabecalhoSnapshot);
+    for (int s = 0; s < SNAP_QTD_SECOES; ++s)
+    {
+        pos = (pos + ALINHAMENTO_SNAPSHOT - 1) / ALINHAMENTO_SNAPSHOT * ALINHAMENTO_SNAPSHOT;
+        cab.secoes[s] = {pos, tamanhos[s]};
+        pos += tamanhos[s];
+    }
+
+    std::ofstream out(caminho, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    out.write(reinterpret_cast<const char *>(&cab), sizeof(cab));
+    uint64_t escrito = sizeof(cab);
+    static const char zeros[ALINHAMENTO_SNAPSHOT] = {};
+    for (int s = 0; s < SNAP_QTD_SECOES; ++s)
+    {
+        out.write(zeros, cab.secoes[s].deslocamento - escrito);
+        if (tamanhos[s] > 0)
+            out.write(static_cast<const char *>(origens[s]), tamanhos[s]);
+        escrito = cab.secoes[s].deslocamento + tamanhos[s];
+    }
+    return (bool)out;
+}
+
+class SnapshotInstancia
+{
+private:
+    ArquivoMapeado arquivo;
+    const CabecalhoSnapshot *cab = nullptr;
+
+    template <typename T>
+    std::vector<T> copiarSecao(int s) const
+    {
+        const T *p = reinterpret_cast<const T *>(arquivo.dados() + cab->secoes[s].deslocamento);
+        return std::vector<T>(p, p + cab->secoes[s].bytes / sizeof(T));
+    }
+
+public:
+    bool abrir(const std::string &caminho, std::string &erro)
+    {
+        cab = nullptr;
+        if (!arquivo.abrir(caminho))
+        {
+            erro = "nao foi possivel abrir o snapshot";
+            return false;
+        }
+        if (arquivo.tamanho() < sizeof(CabecalhoSnapshot))
+        {
+            erro = "snapshot truncado";
+            return false;
+        }
+        const auto *c = reinterpret_cast<const CabecalhoSnapshot *>(arquivo.dados());
+        if (std::memcmp(c->magica, MAGICA_SNAPSHOT, sizeof(c->magica)) != 0)
+        {
+            erro = "arquivo nao e um snapshot DI-NEARP";
+            return false;
+        }
+        if (c->versao != VERSAO_SNAPSHOT || c->tamanhoCabecalho != sizeof(CabecalhoSnapshot))
+        {
+            erro = "versao de snapshot incompativel: " + std::to_string(c->versao);
+            return false;
+        }
+
+        static const uint64_t elemento[SNAP_QTD_SECOES] = {
+            sizeof(NoLido), sizeof(LigacaoLida), sizeof(LigacaoLida), sizeof(LigacaoLida),
+            sizeof(LigacaoLida), sizeof(int), sizeof(int), sizeof(int), 1, sizeof(int), sizeof(int), sizeof(int)};
+        for (int s = 0; s < SNAP_QTD_SECOES; ++s)
+        {
+            const auto &sec = c->secoes[s];
+            if (sec.deslocamento % ALINHAMENTO_SNAPSHOT != 0 || sec.bytes % elemento[s] != 0 ||
+                sec.deslocamento > arquivo.tamanho() || sec.bytes > arquivo.tamanho() - sec.deslocamento)
+            {
+                erro = "secao " + std::to_string(s) + " do snapshot corrompida";
+                return false;
+            }
+        }
+        if (c->qtdVertices <= 0 ||
+            c->secoes[SNAP_CSR_INICIO].bytes != (uint64_t)(c->qtdVertices + 2) * sizeof(int) ||
+            c->secoes[SNAP_CSR_PESO].bytes != c->secoes[SNAP_CSR_DESTINO].bytes ||
+            c->secoes[SNAP_CSR_ARCO].bytes * sizeof(int) != c->secoes[SNAP_CSR_DESTINO].bytes ||
+            c->secoes[SNAP_MATRIZ].bytes != (uint64_t)c->dimensaoMatriz * c->dimensaoMatriz * sizeof(int) ||
+            c->secoes[SNAP_CHAVES].bytes != (uint64_t)c->dimensaoMatriz * sizeof(int) ||
+            (c->secoes[SNAP_PERMUTACAO].bytes != 0 &&
+             c->secoes[SNAP_PERMUTACAO].bytes != (uint64_t)(c->qtdVertices + 1) * sizeof(int)))
+        {
+            erro = "dimensoes do snapshot inconsistentes";
+            return false;
+        }
+
+        cab = c;
+        return true;
+    }
+
+    const CabecalhoSnapshot &cabecalho() const { return *cab; }
+
+    DadosInstancia dados() const
+    {
+        DadosInstancia d;
+        d.nome = std::string(cab->nome, strnlen(cab->nome, sizeof(cab->nome)));
+        d.valorOtimo = cab->valorOtimo;
+        d.qtdVeiculos = cab->qtdVeiculos;
+        d.capacidade = cab->capacidade;
+        d.deposito = cab->deposito;
+        d.qtdVertices = cab->qtdVertices;
+        d.nosRequeridos = copiarSecao<NoLido>(SNAP_NOS);
+        d.arestasRequeridas = copiarSecao<LigacaoLida>(SNAP_ARESTAS_REQ);
+        d.arcosRequeridos = copiarSecao<LigacaoLida>(SNAP_ARCOS_REQ);
+        d.arestasOpcionais = copiarSecao<LigacaoLida>(SNAP_ARESTAS_OPC);
+        d.arcosOpcionais = copiarSecao<LigacaoLida>(SNAP_ARCOS_OPC);
+        d.qtdNosReqDeclarados = (int)d.nosRequeridos.size();
+        d.qtdArestasReqDeclaradas = (int)d.arestasRequeridas.size();
+        d.qtdArcosReqDeclarados = (int)d.arcosRequeridos.size();
+        d.qtdArestasDeclaradas = d.qtdArestasReqDeclaradas + (int)d.arestasOpcionais.size();
+        d.qtdArcosDeclarados = d.qtdArcosReqDeclarados + (int)d.arcosOpcionais.size();
+        return d;
+    }
+
+    GrafoCSR grafo() const
+    {
+        GrafoCSR g;
+        g.qtdVertices = cab->qtdVertices;
+        g.inicio = copiarSecao<int>(SNAP_CSR_INICIO);
+        g.destino = copiarSecao<int>(SNAP_CSR_DESTINO);
+        g.peso = copiarSecao<int>(SNAP_CSR_PESO);
+        g.ehArco = copiarSecao<unsigned char>(SNAP_CSR_ARCO);
+        return g;
+    }
+
+    std::vector<int> permutacao() const { return copiarSecao<int>(SNAP_PERMUTACAO); }
+
+    // Compilado com a renumeração RCM (seção de permutação não vazia)?
+    bool reordenado() const { return cab->secoes[SNAP_PERMUTACAO].bytes > 0; }
+
+    // Aponta a tabela do oráculo para as páginas mapeadas (sem cópia). O
+    // snapshot deve continuar aberto enquanto o oráculo for usado.
+    bool apontarOraculo(OraculoChaves &oraculo) const
+    {
+        std::vector<int> chaves = copiarSecao<int>(SNAP_CHAVES);
+        for (int v : chaves)
+            if (v < 1 || v > cab->qtdVertices)
+                return false;
+        oraculo.apontar(cab->qtdVertices, std::move(chaves),
+                        reinterpret_cast<const int *>(arquivo.dados() + cab->secoes[SNAP_MATRIZ].deslocamento));
+        return oraculo.qtdChaves() == cab->dimensaoMatriz;
+    }
+};
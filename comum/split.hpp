@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <vector>
+
+// Construção rota-primeiro, agrupamento-depois: um tour gigante passa por
+// todos os serviços ignorando a capacidade e o Split o divide, na ordem, nas
+// viagens de menor custo total que respeitam a capacidade.
+//  - tourGigante: vizinho mais próximo a partir do depósito, considerando as
+//    duas orientações das arestas requeridas; O(S²);
+//  - orientarSequencia: com a ordem fixa, escolhe a orientação de cada aresta
+//    por programação dinâmica com dois estados por serviço; O(n);
+//  - dividirTour: Split exato para o tour orientado. O custo da viagem
+//    i+1..j é g(i) + D[j] + volta(j), com D a soma prefixa de serviços e
+//    deslocamentos internos, então p[j] = min g(i) sobre a janela de i com
+//    carga Q[j] - Q[i] <= capacidade, que só anda para a frente: mínimo em
+//    janela deslizante com fila monotônica, O(n). Depois do corte cada
+//    viagem tem as orientações refeitas entre depósito e depósito.
+// dist(u, v) é a distância mínima entre dois vértices (depósito ou extremos
+// de serviços).
+
+struct ServicoTour
+{
+    int id;
+    int inicio, fim; // extremos na orientação original (iguais em nós)
+    int custo, demanda;
+    bool reversivel; // aresta requerida: pode ser atendida de fim para inicio
+};
+
+struct PassoTour
+{
+    int servico; // índice no vetor de serviços
+    bool invertido;
+};
+
+inline int entradaDe(const ServicoTour &s, bool invertido) { return invertido ? s.fim : s.inicio; }
+inline int saidaDe(const ServicoTour &s, bool invertido) { return invertido ? s.inicio : s.fim; }
+
+// Sem rng escolhe sempre o mais próximo (empate: menor índice, orientação
+// original); com rng sorteia entre os 'candidatos' pares (serviço,
+// orientação) mais próximos da posição atual.
+template <typename Distancia>
+std::vector<PassoTour> tourGigante(const std::vector<ServicoTour> &servicos, int deposito, Distancia &&dist,
+                                   std::mt19937 *rng = nullptr, int candidatos = 3)
+{
+    int n = (int)servicos.size();
+    int r = rng ? std::max(1, candidatos) : 1;
+    std::vector<int> pendentes(n);
+    for (int i = 0; i < n; ++i)
+        pendentes[i] = i;
+    std::vector<PassoTour> tour;
+    tour.reserve(n);
+    // Os r melhores (distância, posição em pendentes, invertido), em ordem
+    std::vector<std::pair<long long, PassoTour>> melhores;
+    std::vector<int> posicao;
+
+    int atual = deposito;
+    while (!pendentes.empty())
+    {
+        melhores.clear();
+        posicao.clear();
+        auto considerar = [&](int p, bool invertido)
+        {
+            long long d = dist(atual, entradaDe(servicos[pendentes[p]], invertido));
+            if ((int)melhores.size() == r && d >= melhores.back().first)
+                return;
+            int k = (int)melhores.size();
+            if (k == r)
+            {
+                melhores.pop_back();
+                posicao.pop_back();
+                --k;
+            }
+            while (k > 0 && melhores[k - 1].first > d)
+                --k;
+            melhores.insert(melhores.begin() + k, {d, {pendentes[p], invertido}});
+            posicao.insert(posicao.begin() + k, p);
+        };
+        for (int p = 0; p < (int)pendentes.size(); ++p)
+        {
+            considerar(p, false);
+            if (servicos[pendentes[p]].reversivel)
+                considerar(p, true);
+        }
+
+        int e = rng ? std::uniform_int_distribution<int>(0, (int)melhores.size() - 1)(*rng) : 0;
+        PassoTour passo = melhores[e].second;
+        tour.push_back(passo);
+        atual = saidaDe(servicos[passo.servico], passo.invertido);
+        // Remoção preservando a ordem dos pendentes (empates pelo menor índice)
+        pendentes.erase(pendentes.begin() + posicao[e]);
+    }
+    return tour;
+}
+
+// Orientações ótimas de passos[0..n) para a sequência de → serviços → ate.
+// Devolve o custo total (serviços mais deslocamentos).
+template <typename Distancia>
+long long orientarSequencia(PassoTour *passos, int n, const std::vector<ServicoTour> &servicos, int de, int ate,
+                            Distancia &&dist)
+{
+    if (n == 0)
+        return dist(de, ate);
+    const long long SEM = LLONG_MAX / 4;
+    // custo[o]: melhor custo até o serviço atual terminando na orientação o
+    std::vector<char> escolha(2 * (std::size_t)n, 0);
+    long long custo[2] = {SEM, SEM};
+    for (int o = 0; o < 2; ++o)
+    {
+        const ServicoTour &s = servicos[passos[0].servico];
+        if (o == 0 || s.reversivel)
+            custo[o] = dist(de, entradaDe(s, o)) + (long long)s.custo;
+    }
+    for (int k = 1; k < n; ++k)
+    {
+        const ServicoTour &a = servicos[passos[k - 1].servico], &s = servicos[passos[k].servico];
+        long long novo[2] = {SEM, SEM};
+        for (int o = 0; o < 2; ++o)
+        {
+            if (o == 1 && !s.reversivel)
+                continue;
+            for (int q = 0; q < 2; ++q)
+            {
+                if (custo[q] >= SEM)
+                    continue;
+                long long c = custo[q] + dist(saidaDe(a, q), entradaDe(s, o)) + s.custo;
+                if (c < novo[o])
+                {
+                    novo[o] = c;
+                    escolha[2 * (std::size_t)k + o] = (char)q;
+                }
+            }
+        }
+        custo[0] = novo[0];
+        custo[1] = novo[1];
+    }
+    const ServicoTour &ultimo = servicos[passos[n - 1].servico];
+    long long total[2] = {custo[0] < SEM ? custo[0] + dist(saidaDe(ultimo, false), ate) : SEM,
+                          custo[1] < SEM ? custo[1] + dist(saidaDe(ultimo, true), ate) : SEM};
+    int o = total[1] < total[0] ? 1 : 0;
+    long long resultado = total[o];
+    for (int k = n - 1; k >= 0; --k)
+    {
+        passos[k].invertido = o == 1;
+        o = escolha[2 * (std::size_t)k + o];
+    }
+    return resultado;
+}
+
+// Split linear do tour (orientações fixas) seguido da reorientação de cada
+// viagem. Um serviço com demanda acima da capacidade fica sozinho numa viagem.
+template <typename Distancia>
+std::vector<std::vector<PassoTour>> dividirTour(const std::vector<PassoTour> &tour,
+                                                const std::vector<ServicoTour> &servicos, int capacidade,
+                                                int deposito, Distancia &&dist)
+{
+    int n = (int)tour.size();
+    // Posições 1..n do tour; Q e D somas prefixas de demanda e custo interno
+    std::vector<long long> carga(n + 1, 0), interno(n + 1, 0), g(n + 1, 0), p(n + 1, 0);
+    std::vector<int> pred(n + 1, 0), fila(n + 1);
+    for (int t = 1; t <= n; ++t)
+    {
+        const ServicoTour &s = servicos[tour[t - 1].servico];
+        carga[t] = carga[t - 1] + s.demanda;
+        interno[t] = interno[t - 1] + s.custo;
+        if (t > 1)
+        {
+            const PassoTour &a = tour[t - 2];
+            interno[t] += dist(saidaDe(servicos[a.servico], a.invertido), entradaDe(s, tour[t - 1].invertido));
+        }
+    }
+
+    int cabeca = 0, cauda = 0;
+    for (int j = 1; j <= n; ++j)
+    {
+        // i = j-1 entra na janela: g(i) = p[i] + ida(i+1) + c(i+1) - D[i+1]
+        int i = j - 1;
+        const ServicoTour &s = servicos[tour[i].servico];
+        g[i] = p[i] + dist(deposito, entradaDe(s, tour[i].invertido)) + s.custo - interno[i + 1];
+        while (cauda > cabeca && g[fila[cauda - 1]] >= g[i])
+            --cauda;
+        fila[cauda++] = i;
+        while (carga[j] - carga[fila[cabeca]] > capacidade && fila[cabeca] != i)
+            ++cabeca;
+
+        const PassoTour &u = tour[j - 1];
+        pred[j] = fila[cabeca];
+        p[j] = g[pred[j]] + interno[j] + dist(saidaDe(servicos[u.servico], u.invertido), deposito);
+    }
+
+    std::vector<std::vector<PassoTour>> viagens;
+    for (int j = n; j > 0; j = pred[j])
+        viagens.emplace_back(tour.begin() + pred[j], tour.begin() + j);
+    std::reverse(viagens.begin(), viagens.end());
+    for (auto &v : viagens)
+        orientarSequencia(v.data(), (int)v.size(), servicos, deposito, deposito, dist);
+    return viagens;
+}
+
+// Tour gigante (determinístico ou sorteado), orientação ótima do tour
+// inteiro e Split.
+template <typename Distancia>
+std::vector<std::vector<PassoTour>> construirPorSplit(const std::vector<ServicoTour> &servicos, int capacidade,
+                                                      int deposito, Distancia &&dist, std::mt19937 *rng = nullptr)
+{
+    std::vector<PassoTour> tour = tourGigante(servicos, deposito, dist, rng);
+    orientarSequencia(tour.data(), (int)tour.size(), servicos, deposito, deposito, dist);
+    return dividirTour(tour, servicos, capacidade, deposito, dist);
+}
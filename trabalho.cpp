@@ -1,12 +1,24 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <tuple>
 #include <unordered_set>
 #include <string>
 #include <algorithm>
 #include <climits>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "comum/leitor_instancia.hpp"
+#include "comum/grafo_csr.hpp"
+#include "comum/reordenacao.hpp"
+#include "comum/estatisticas_grafo.hpp"
+#include "comum/pipeline.hpp"
 
 struct Aresta
 {
@@ -28,132 +40,50 @@ std::vector<Arco> arcos_requeridos;
 std::vector<Aresta> arestas_opcionais;
 std::vector<Arco> arcos_opcionais;
 
-std::vector<std::vector<std::pair<int, int>>> adj_arestas;
-std::vector<std::vector<std::pair<int, int>>> adj_arcos;
+GrafoCSR grafo;
+GrafoCSR grafo_reverso;
+Reordenacao reordenacao;
 
-const int INF = 1e9;
-std::vector<std::vector<int>> dist;
-std::vector<std::vector<int>> pred;
+// Métricas calculadas sob demanda e memorizadas (comum/estatisticas_grafo.hpp)
+std::unique_ptr<EstatisticasGrafo> estatisticas;
 
-void lerArquivo(const std::string &nome_arquivo)
+bool lerArquivo(const std::string &nome_arquivo, bool reordenar = false)
 {
-    std::ifstream arq(nome_arquivo);
-    std::string linha;
-
-    enum Estado
-    {
-        NONE,
-        REN,
-        REE,
-        REA,
-        EDGE,
-        ARC
-    } estado = NONE;
-
-    int linhasEDGE = 0;
-
-    while (getline(arq, linha))
+    DadosInstancia dados;
+    if (!lerInstancia(nome_arquivo, dados))
     {
-        if (linha.empty())
-            continue;
-
-        std::stringstream ss(linha);
-        std::string palavra;
-        ss >> palavra;
-
-        // Cabeçalho
-        if (palavra == "Capacity:")
-        {
-            ss >> capacidade;
-        }
-        else if (palavra == "Depot")
-        {
-            ss >> palavra >> deposito;
-        }
-        else if (palavra == "#Nodes:")
-        {
-            ss >> num_vertices;
-            adj_arestas.resize(num_vertices + 1);
-            adj_arcos.resize(num_vertices + 1);
-        }
-        else if (palavra == "ReN.")
-        {
-            estado = REN;
-            continue;
-        }
-        else if (palavra == "ReE.")
-        {
-            estado = REE;
-            continue;
-        }
-        else if (palavra == "ReA.")
-        {
-            estado = REA;
-            continue;
-        }
-        else if (palavra == "EDGE")
-        {
-            estado = EDGE;
-            continue;
-        }
-        else if (palavra == "ARC")
-        {
-            estado = ARC;
-            continue;
-        }
-
-        // Leitura das seções
-        if (estado == REN && palavra[0] == 'N')
-        {
-            int id = std::stoi(palavra.substr(1));
-            int demanda, custo;
-            ss >> demanda >> custo;
-            vertices_requeridos.insert(id);
-        }
-        else if (estado == REE && palavra[0] == 'E')
-        {
-            int de, para, custo, demanda, servico;
-            ss >> de >> para >> custo >> demanda >> servico;
-            arestas_requeridas.push_back({de, para, custo, demanda, servico});
-            adj_arestas[de].push_back({para, custo});
-            adj_arestas[para].push_back({de, custo});
-        }
-        else if (estado == REA && palavra[0] == 'A')
-        {
-            int de, para, custo, demanda, servico;
-            ss >> de >> para >> custo >> demanda >> servico;
-            arcos_requeridos.push_back({de, para, custo, demanda, servico});
-            adj_arcos[de].push_back({para, custo});
-        }
-        else if (estado == EDGE)
-        {
-            // Divide a linha manualmente ignorando o identificador E#
-            std::istringstream linha_stream(linha);
-            std::string rotulo;
-            int de, para, custo;
-
-            linha_stream >> rotulo >> de >> para >> custo;
-
-            if (!linha_stream.fail())
-            {
-                arestas_opcionais.push_back({de, para, custo, 0, 0});
-                adj_arestas[de].push_back({para, custo});
-                adj_arestas[para].push_back({de, custo});
-                linhasEDGE++;
-            }
-        }
-
-        else if (estado == ARC && isdigit(palavra[0]))
-        {
-            int de = std::stoi(palavra);
-            int para, custo;
-            ss >> para >> custo;
-            arcos_opcionais.push_back({de, para, custo, 0, 0});
-            adj_arcos[de].push_back({para, custo});
-        }
+        reportarErrosLeitura(std::cerr, nome_arquivo, dados);
+        return false;
     }
 
-    arq.close();
+    // Renumeração opcional (RCM a partir do depósito); a saída usa os ids originais
+    if (reordenar)
+        reordenacao = reordenarInstancia(dados);
+
+    // Cabeçalho
+    capacidade = dados.capacidade;
+    deposito = dados.deposito;
+    num_vertices = dados.qtdVertices;
+
+    // Seções
+    for (const auto &n : dados.nosRequeridos)
+        vertices_requeridos.insert(n.vertice);
+
+    for (const auto &e : dados.arestasRequeridas)
+        arestas_requeridas.push_back({e.origem, e.destino, e.custo, e.demanda, e.custoServico});
+    for (const auto &a : dados.arcosRequeridos)
+        arcos_requeridos.push_back({a.origem, a.destino, a.custo, a.demanda, a.custoServico});
+    for (const auto &e : dados.arestasOpcionais)
+        arestas_opcionais.push_back({e.origem, e.destino, e.custo, 0, 0});
+    for (const auto &a : dados.arcosOpcionais)
+        arcos_opcionais.push_back({a.origem, a.destino, a.custo, 0, 0});
+
+    // Grafo contíguo montado uma única vez após a leitura
+    grafo = construirCSR(dados);
+    grafo_reverso = transpor(grafo);
+    estatisticas = std::make_unique<EstatisticasGrafo>(grafo, grafo_reverso);
+
+    return true;
 }
 
 int contarVertices() { return num_vertices; }
@@ -163,303 +93,514 @@ int contarVerticesRequeridos() { return vertices_requeridos.size(); }
 int contarArestasRequeridas() { return arestas_requeridas.size(); }
 int contarArcosRequeridos() { return arcos_requeridos.size(); }
 
-double calcularDensidade()
+double densidadeMista(int V, int total_arestas, int total_arcos)
 {
-    int total_arestas = contarArestas();
-    int total_arcos = contarArcos();
-    int V = num_vertices;
-
     double densidade_arestas = 0.0;
     double densidade_arcos = 0.0;
 
     // Densidade para parte não direcionada
     if (total_arestas > 0)
-        densidade_arestas = (2.0 * total_arestas) / (V * (V - 1));
+        densidade_arestas = (2.0 * total_arestas) / ((double)V * (V - 1));
 
     // Densidade para parte direcionada
     if (total_arcos > 0)
-        densidade_arcos = (1.0 * total_arcos) / (V * (V - 1));
+        densidade_arcos = (1.0 * total_arcos) / ((double)V * (V - 1));
 
     // Soma das duas densidades
     return densidade_arestas + densidade_arcos;
 }
 
-std::vector<bool> visitado;
-void dfs_nao_direcionado(int u)
+double calcularDensidade() { return densidadeMista(num_vertices, contarArestas(), contarArcos()); }
+
+int contarComponentesConexas() { return estatisticas->componentesConexas(); }
+
+int contarComponentesFortementeConexas() { return estatisticas->componentesFortementeConexas(); }
+
+int grauMinimo() { return estatisticas->grauMinimo(); }
+int grauMaximo() { return estatisticas->grauMaximo(); }
+
+// Brandes exato em paralelo; empates entre caminhos mínimos dividem o crédito.
+// Caminho médio e diâmetro saem da mesma passada por origem.
+const std::vector<double> &calcularIntermediacao() { return estatisticas->intermediacao(); }
+double calcularCaminhoMedio() { return estatisticas->caminhoMedio(); }
+int calcularDiametro() { return estatisticas->diametro(); }
+
+// Linhas 11 a 13: no modo aproximado trazem o erro (meia-largura do intervalo
+// de 95%) ou os limites do diâmetro ao lado do valor. prefixo é a numeração
+// usada no saida.txt e vazio no menu.
+void escreverIntermediacao(std::ostream &out, const char *prefixo)
 {
-    visitado[u] = true;
-    for (auto [v, _] : adj_arestas[u])
+    if (!estatisticas->aproximado())
     {
-        if (!visitado[v])
-            dfs_nao_direcionado(v);
+        const auto &intermedia = calcularIntermediacao();
+        for (int i = 1; i <= num_vertices; ++i)
+            out << prefixo << "Intermediacao vertice " << i << ": " << intermedia[reordenacao.paraNovo(i)] << "\n";
+        return;
+    }
+    const ResumoAproximado &est = estatisticas->estimativas();
+    for (int i = 1; i <= num_vertices; ++i)
+    {
+        const Estimativa &e = est.intermediacao[reordenacao.paraNovo(i)];
+        out << prefixo << "Intermediacao vertice " << i << ": " << e.valor << " +/- " << e.erro << "\n";
     }
 }
 
-int contarComponentesConexas()
+void escreverCaminhoMedio(std::ostream &out, const char *prefixo)
 {
-    visitado.assign(num_vertices + 1, false);
-    int comp = 0;
-    for (int i = 1; i <= num_vertices; ++i)
+    out << prefixo << "Caminho medio: ";
+    if (!estatisticas->aproximado())
     {
-        if (!visitado[i])
-        {
-            dfs_nao_direcionado(i);
-            comp++;
-        }
+        out << calcularCaminhoMedio() << "\n";
+        return;
     }
-    return comp;
+    const Estimativa &e = estatisticas->estimativas().caminhoMedio;
+    out << e.valor << " +/- " << e.erro << "\n";
 }
 
-std::vector<std::vector<int>> grafo_reverso;
-void dfs1(int u, std::vector<bool> &vis, std::vector<int> &ordem)
+void escreverDiametro(std::ostream &out, const char *prefixo)
 {
-    vis[u] = true;
-    for (auto [v, _] : adj_arcos[u])
-        if (!vis[v])
-            dfs1(v, vis, ordem);
-    ordem.push_back(u);
+    out << prefixo << "Diametro: ";
+    if (!estatisticas->aproximado())
+    {
+        out << calcularDiametro() << "\n";
+        return;
+    }
+    const ResumoAproximado &est = estatisticas->estimativas();
+    out << est.diametroInferior;
+    if (est.diametroSuperior >= 0)
+        out << " (limite superior " << est.diametroSuperior << ")\n";
+    else
+        out << " (limite inferior)\n";
 }
 
-void dfs2(int u, std::vector<bool> &vis)
+void escreverEstatisticas(std::ostream &out)
 {
-    vis[u] = true;
-    for (int v : grafo_reverso[u])
-        if (!vis[v])
-            dfs2(v, vis);
+    out << "1. Quantidade de vertices: " << contarVertices() << "\n";
+    out << "2. Quantidade de arestas: " << contarArestas() << "\n";
+    out << "3. Quantidade de arcos: " << contarArcos() << "\n";
+    out << "4. Quantidade de vertices requeridos: " << contarVerticesRequeridos() << "\n";
+    out << "5. Quantidade de arestas requeridas: " << contarArestasRequeridas() << "\n";
+    out << "6. Quantidade de arcos requeridos: " << contarArcosRequeridos() << "\n";
+    out << "7. Densidade do grafo: " << calcularDensidade() << "\n";
+    out << "8. Componentes conexas: " << contarComponentesConexas() << "\n";
+    out << "9. Grau minimo: " << grauMinimo() << "\n";
+    out << "10. Grau maximo: " << grauMaximo() << "\n";
+    escreverIntermediacao(out, "11. ");
+    escreverCaminhoMedio(out, "12. ");
+    escreverDiametro(out, "13. ");
 }
 
-int contarComponentesFortementeConexas()
+void exibirTodasEstatisticas() { escreverEstatisticas(std::cout); }
+
+void salvarEstatisticasEmArquivo(const std::string &nome_arquivo)
 {
-    grafo_reverso.assign(num_vertices + 1, {});
-    for (int u = 1; u <= num_vertices; ++u)
-        for (const auto &vizinho : adj_arcos[u])
-            grafo_reverso[vizinho.first].push_back(u);
+    std::ofstream out(nome_arquivo);
+    escreverEstatisticas(out);
+}
 
-    std::vector<bool> vis(num_vertices + 1, false);
-    std::vector<int> ordem;
+void menu()
+{
+    std::cout << "\nEscolha uma opcao para calcular (1 a 13) ou 0 para sair:\n";
+    std::cout << "1. Quantidade de vertices\n";
+    std::cout << "2. Quantidade de arestas\n";
+    std::cout << "3. Quantidade de arcos\n";
+    std::cout << "4. Quantidade de vertices requeridos\n";
+    std::cout << "5. Quantidade de arestas requeridas\n";
+    std::cout << "6. Quantidade de arcos requeridos\n";
+    std::cout << "7. Densidade do grafo\n";
+    std::cout << "8. Componentes conectados\n";
+    std::cout << "9. Grau minimo dos vertices\n";
+    std::cout << "10. Grau maximo dos vertices\n";
+    std::cout << "11. Intermediacao de cada vertice\n";
+    std::cout << "12. Caminho medio\n";
+    std::cout << "13. Diametro\n";
+    std::cout << "14. Mostrar todas as estatisticas\n";
+    std::cout << "0. Sair\n> ";
+}
 
-    for (int i = 1; i <= num_vertices; ++i)
-        if (!vis[i])
-            dfs1(i, vis, ordem);
+// ---------------------------------------------------------------------------
+// Modo em lote: estatísticas de várias instâncias sem o menu interativo, um
+// registro por instância (CSV ou JSON Lines) com o tempo de cada métrica.
+// ---------------------------------------------------------------------------
 
-    std::fill(vis.begin(), vis.end(), false);
-    std::reverse(ordem.begin(), ordem.end());
-    int comp = 0;
+struct ItemLote
+{
+    std::string nome;
+    DadosInstancia dados;
+    GrafoCSR grafo, reverso;
+    std::unique_ptr<EstatisticasGrafo> estatisticas;
+    double tempoLeitura = 0;
+    std::vector<std::string> valores;
+    std::vector<double> tempos;     // ms, na ordem das métricas escolhidas
+    bool aproximado = false;        // alguma métrica veio de amostragem
+    std::vector<std::string> erros; // modo aproximado, uma por métrica com erro
+};
 
-    for (int u : ordem)
-        if (!vis[u])
-        {
-            dfs2(u, vis);
-            comp++;
-        }
+// erro (opcional) dá a coluna nomeErro do modo aproximado: o erro da
+// estimativa ou, no diâmetro, o limite superior (vazio se não houver)
+struct MetricaLote
+{
+    const char *nome;
+    std::function<std::string(ItemLote &)> calcular;
+    const char *nomeErro = nullptr;
+    std::function<std::string(ItemLote &)> erro = nullptr;
+};
 
-    return comp;
+template <typename T>
+std::string formatarValor(T valor)
+{
+    std::ostringstream ss;
+    ss.precision(10);
+    ss << valor;
+    return ss.str();
 }
 
-std::vector<int> calcularGrausTotais()
+// Métricas disponíveis, na ordem do saida.txt. A intermediação entra como o
+// maior valor entre os vértices; ela, o caminho médio e o diâmetro saem da
+// mesma passada, cujo tempo fica com a primeira delas que for pedida.
+const std::vector<MetricaLote> &metricasLote()
 {
-    std::vector<int> grau(num_vertices + 1, 0);
+    static const std::vector<MetricaLote> metricas = {
+        {"vertices", [](ItemLote &i)
+         { return formatarValor(i.dados.qtdVertices); }},
+        {"arestas", [](ItemLote &i)
+         { return formatarValor(i.dados.arestasRequeridas.size() + i.dados.arestasOpcionais.size()); }},
+        {"arcos", [](ItemLote &i)
+         { return formatarValor(i.dados.arcosRequeridos.size() + i.dados.arcosOpcionais.size()); }},
+        {"vertices_requeridos", [](ItemLote &i)
+         {
+             std::unordered_set<int> distintos;
+             for (const auto &n : i.dados.nosRequeridos)
+                 distintos.insert(n.vertice);
+             return formatarValor(distintos.size());
+         }},
+        {"arestas_requeridas", [](ItemLote &i)
+         { return formatarValor(i.dados.arestasRequeridas.size()); }},
+        {"arcos_requeridos", [](ItemLote &i)
+         { return formatarValor(i.dados.arcosRequeridos.size()); }},
+        {"densidade", [](ItemLote &i)
+         {
+             int arestas = (int)(i.dados.arestasRequeridas.size() + i.dados.arestasOpcionais.size());
+             int arcos = (int)(i.dados.arcosRequeridos.size() + i.dados.arcosOpcionais.size());
+             return formatarValor(densidadeMista(i.dados.qtdVertices, arestas, arcos));
+         }},
+        {"componentes", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->componentesConexas()); }},
+        {"componentes_fortes", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->componentesFortementeConexas()); }},
+        {"grau_min", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->grauMinimo()); }},
+        {"grau_max", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->grauMaximo()); }},
+        {"intermediacao_max", [](ItemLote &i)
+         {
+             const auto &v = i.estatisticas->intermediacao();
+             return formatarValor(v.size() > 1 ? *std::max_element(v.begin() + 1, v.end()) : 0.0);
+         },
+         "intermediacao_max_erro", [](ItemLote &i)
+         {
+             const auto &v = i.estatisticas->estimativas().intermediacao;
+             if (v.size() <= 1)
+                 return formatarValor(0.0);
+             auto maior = std::max_element(v.begin() + 1, v.end(), [](const Estimativa &a, const Estimativa &b)
+                                           { return a.valor < b.valor; });
+             return formatarValor(maior->erro);
+         }},
+        {"caminho_medio", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->caminhoMedio()); },
+         "caminho_medio_erro", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->estimativas().caminhoMedio.erro); }},
+        {"diametro", [](ItemLote &i)
+         { return formatarValor(i.estatisticas->diametro()); },
+         "diametro_superior", [](ItemLote &i)
+         {
+             long long superior = i.estatisticas->estimativas().diametroSuperior;
+             return superior >= 0 ? formatarValor(superior) : std::string();
+         }},
+    };
+    return metricas;
+}
 
-    for (int u = 1; u <= num_vertices; ++u)
-        grau[u] += adj_arestas[u].size();
+struct ConfiguracaoLote
+{
+    std::vector<std::string> caminhos; // pastas (todos os .dat) ou arquivos
+    std::vector<int> metricas;         // índices em metricasLote()
+    bool json = false;
+    std::string saida; // vazio = saída padrão
+    bool aproximado = false;
+    ConfiguracaoAproximacao aproximacao;
+    ConfiguracaoPipeline pipeline;
+};
 
-    for (int u = 1; u <= num_vertices; ++u)
+// Lista de métricas separadas por vírgula ("todas" seleciona todas)
+bool lerMetricas(const std::string &lista, std::vector<int> &metricas)
+{
+    const auto &disponiveis = metricasLote();
+    std::stringstream ss(lista);
+    std::string nome;
+    while (std::getline(ss, nome, ','))
     {
-        for (const auto &vizinho : adj_arcos[u])
+        if (nome == "todas")
         {
-            int v = vizinho.first;
-            grau[u]++;
-            grau[v]++;
+            for (int m = 0; m < (int)disponiveis.size(); ++m)
+                metricas.push_back(m);
+            continue;
         }
+        auto it = std::find_if(disponiveis.begin(), disponiveis.end(), [&](const MetricaLote &m)
+                               { return nome == m.nome; });
+        if (it == disponiveis.end())
+        {
+            std::cerr << "Metrica desconhecida: " << nome << "\n";
+            return false;
+        }
+        metricas.push_back((int)(it - disponiveis.begin()));
     }
-
-    return grau;
+    return true;
 }
 
-int grauMinimo()
+std::string escaparJson(const std::string &texto)
 {
-    auto graus = calcularGrausTotais();
-    return *std::min_element(graus.begin() + 1, graus.end());
+    std::string r;
+    for (char c : texto)
+    {
+        if (c == '"' || c == '\\')
+            r += '\\';
+        r += c;
+    }
+    return r;
 }
 
-int grauMaximo()
+int executarLote(const ConfiguracaoLote &config)
 {
-    auto graus = calcularGrausTotais();
-    return *std::max_element(graus.begin() + 1, graus.end());
-}
+    std::vector<std::string> entradas;
+    for (const auto &caminho : config.caminhos)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(caminho, ec))
+        {
+            std::vector<std::string> daPasta;
+            for (const auto &entrada : std::filesystem::directory_iterator(caminho))
+                if (entrada.path().extension() == ".dat")
+                    daPasta.push_back(entrada.path().string());
+            std::sort(daPasta.begin(), daPasta.end());
+            entradas.insert(entradas.end(), daPasta.begin(), daPasta.end());
+        }
+        else
+            entradas.push_back(caminho);
+    }
 
-void floydWarshall()
-{
-    int n = num_vertices;
-    dist.assign(n + 1, std::vector<int>(n + 1, INF));
-    pred.assign(n + 1, std::vector<int>(n + 1, -1));
+    std::ofstream arquivo;
+    if (!config.saida.empty())
+    {
+        arquivo.open(config.saida);
+        if (!arquivo)
+        {
+            std::cerr << "Nao foi possivel criar " << config.saida << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = config.saida.empty() ? std::cout : arquivo;
+    const auto &metricas = metricasLote();
+
+    // Métricas escolhidas que ganham coluna de erro no modo aproximado
+    std::vector<int> comErro;
+    if (config.aproximado)
+        for (int m : config.metricas)
+            if (metricas[m].erro)
+                comErro.push_back(m);
 
-    for (int i = 1; i <= n; ++i)
+    if (!config.json)
     {
-        dist[i][i] = 0;
-        pred[i][i] = i;
+        out << "instancia";
+        for (int m : config.metricas)
+            out << "," << metricas[m].nome;
+        if (config.aproximado)
+            out << ",aproximado";
+        for (int m : comErro)
+            out << "," << metricas[m].nomeErro;
+        out << ",leitura_ms";
+        for (int m : config.metricas)
+            out << ",tempo_" << metricas[m].nome << "_ms";
+        out << "\n";
     }
 
-    for (int u = 1; u <= n; ++u)
-        for (auto [v, c] : adj_arestas[u])
+    // Com várias instâncias ao mesmo tempo cada uma usa uma thread só
+    int threadsPorInstancia = config.pipeline.threadsResolucao > 1 ? 1 : 0;
+    using Relogio = std::chrono::steady_clock;
+    auto ms = [](Relogio::time_point a, Relogio::time_point b)
+    { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    std::mutex mtxSaida;
+    int falhas = 0;
+    EtapasPipeline<ItemLote> etapas;
+    etapas.ler = [&](const std::string &caminho) -> std::unique_ptr<ItemLote>
+    {
+        auto ini = Relogio::now();
+        auto item = std::make_unique<ItemLote>();
+        item->nome = std::filesystem::path(caminho).stem().string();
+        if (!lerInstancia(caminho, item->dados))
         {
-            dist[u][v] = std::min(dist[u][v], c);
-            dist[v][u] = std::min(dist[v][u], c);
-            pred[u][v] = u;
-            pred[v][u] = v;
+            std::lock_guard<std::mutex> lock(mtxSaida);
+            reportarErrosLeitura(std::cerr, caminho, item->dados);
+            falhas++;
+            return nullptr;
         }
-
-    for (int u = 1; u <= n; ++u)
-        for (auto [v, c] : adj_arcos[u])
+        item->grafo = construirCSR(item->dados);
+        item->reverso = transpor(item->grafo);
+        item->estatisticas = std::make_unique<EstatisticasGrafo>(item->grafo, item->reverso, threadsPorInstancia);
+        if (config.aproximado)
+            item->estatisticas->usarAproximacao(config.aproximacao);
+        item->tempoLeitura = ms(ini, Relogio::now());
+        return item;
+    };
+    etapas.preprocessar = [](ItemLote &) {};
+    etapas.resolver = [&](ItemLote &item)
+    {
+        for (int m : config.metricas)
         {
-            dist[u][v] = std::min(dist[u][v], c);
-            pred[u][v] = u;
+            auto ini = Relogio::now();
+            item.valores.push_back(metricas[m].calcular(item));
+            item.tempos.push_back(ms(ini, Relogio::now()));
         }
-
-    for (int k = 1; k <= n; ++k)
-        for (int i = 1; i <= n; ++i)
-            for (int j = 1; j <= n; ++j)
-                if (dist[i][k] < INF && dist[k][j] < INF && dist[i][k] + dist[k][j] < dist[i][j])
-                {
-                    dist[i][j] = dist[i][k] + dist[k][j];
-                    pred[i][j] = pred[k][j];
-                }
-}
-
-std::vector<int> calcularIntermediacao()
-{
-    std::vector<int> intermedia(num_vertices + 1, 0);
-    for (int s = 1; s <= num_vertices; ++s)
+        // Sem métrica de caminhos nada foi amostrado (e nada é calculado aqui)
+        if (!comErro.empty())
+        {
+            item.aproximado = !item.estatisticas->estimativas().exato;
+            for (int m : comErro)
+                item.erros.push_back(metricas[m].erro(item));
+        }
+    };
+    etapas.escrever = [&](ItemLote &item)
     {
-        for (int t = 1; t <= num_vertices; ++t)
+        std::ostringstream registro;
+        registro.precision(6);
+        registro << std::fixed;
+        if (config.json)
         {
-            if (s == t || dist[s][t] >= INF)
-                continue;
-            int atual = t;
-            while (pred[s][atual] != s && pred[s][atual] != -1)
-            {
-                int anterior = pred[s][atual];
-                if (anterior != s && anterior != t)
-                    intermedia[anterior]++;
-                atual = anterior;
-            }
+            registro << "{\"instancia\":\"" << escaparJson(item.nome) << "\"";
+            for (std::size_t k = 0; k < config.metricas.size(); ++k)
+                registro << ",\"" << metricas[config.metricas[k]].nome << "\":" << item.valores[k];
+            if (config.aproximado)
+                registro << ",\"aproximado\":" << (item.aproximado ? "true" : "false");
+            for (std::size_t k = 0; k < comErro.size(); ++k)
+                registro << ",\"" << metricas[comErro[k]].nomeErro
+                         << "\":" << (item.erros[k].empty() ? "null" : item.erros[k]);
+            registro << ",\"tempos_ms\":{\"leitura\":" << item.tempoLeitura;
+            for (std::size_t k = 0; k < config.metricas.size(); ++k)
+                registro << ",\"" << metricas[config.metricas[k]].nome << "\":" << item.tempos[k];
+            registro << "}}\n";
         }
-    }
-    return intermedia;
+        else
+        {
+            registro << item.nome;
+            for (const auto &v : item.valores)
+                registro << "," << v;
+            if (config.aproximado)
+                registro << "," << (item.aproximado ? 1 : 0);
+            for (const auto &e : item.erros)
+                registro << "," << e;
+            registro << "," << item.tempoLeitura;
+            for (double t : item.tempos)
+                registro << "," << t;
+            registro << "\n";
+        }
+        std::lock_guard<std::mutex> lock(mtxSaida);
+        out << registro.str() << std::flush;
+    };
+
+    executarPipeline(entradas, config.pipeline, etapas);
+    return falhas == 0 ? 0 : 1;
 }
 
-double calcularCaminhoMedio()
+int main(int argc, char *argv[])
 {
-    long long soma = 0;
-    int pares_validos = 0;
-    for (int i = 1; i <= num_vertices; ++i)
+    bool reordenar = false, lote = false;
+    ConfiguracaoLote configLote;
+    configLote.pipeline.threadsResolucao = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
     {
-        for (int j = 1; j <= num_vertices; ++j)
+        std::string opcao = argv[i];
+        if (opcao == "--reordenar")
+            reordenar = true;
+        else if (opcao == "--aproximado")
+            configLote.aproximado = true;
+        else if (opcao == "--erro" || opcao == "--tempo")
         {
-            if (i != j && dist[i][j] < INF)
+            double valor;
+            if (i + 1 >= argc)
             {
-                soma += dist[i][j];
-                pares_validos++;
+                std::cerr << "Falta o valor de " << opcao << "\n";
+                return 1;
             }
+            if (!lerReal(argv[i + 1], valor) || valor < 0)
+            {
+                std::cerr << "Valor invalido para " << opcao << ": " << argv[i + 1] << "\n";
+                return 1;
+            }
+            ++i;
+            if (opcao == "--erro")
+                configLote.aproximacao.erroRelativo = valor;
+            else
+                configLote.aproximacao.tempoMaximo = valor;
         }
-    }
-    if (pares_validos == 0)
-        return -1;
-    return static_cast<double>(soma) / pares_validos;
-}
-
-int calcularDiametro()
-{
-    int diametro = 0;
-    for (int i = 1; i <= num_vertices; ++i)
-    {
-        for (int j = 1; j <= num_vertices; ++j)
+        else if (opcao == "--lote")
+        {
+            // Pastas e arquivos até a próxima opção
+            lote = true;
+            while (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0)
+                configLote.caminhos.push_back(argv[++i]);
+        }
+        else if (opcao == "--metricas" && i + 1 < argc)
+        {
+            if (!lerMetricas(argv[++i], configLote.metricas))
+                return 1;
+        }
+        else if (opcao == "--formato" && i + 1 < argc)
         {
-            if (i != j && dist[i][j] < INF)
+            std::string formato = argv[++i];
+            if (formato != "csv" && formato != "json")
             {
-                diametro = std::max(diametro, dist[i][j]);
+                std::cerr << "Formato desconhecido: " << formato << "\n";
+                return 1;
             }
+            configLote.json = formato == "json";
+        }
+        else if (opcao == "--saida" && i + 1 < argc)
+            configLote.saida = argv[++i];
+        else
+        {
+            ResultadoOpcao resultado = lerOpcaoPipeline(argc, argv, i, configLote.pipeline);
+            if (resultado == ResultadoOpcao::Desconhecida)
+                std::cerr << "Opcao desconhecida: " << opcao << "\n";
+            if (resultado != ResultadoOpcao::Aceita)
+                return 1;
         }
     }
-    return diametro;
-}
-void exibirTodasEstatisticas()
-{
-    std::cout << "1. Quantidade de vertices: " << contarVertices() << "\n";
-    std::cout << "2. Quantidade de arestas: " << contarArestas() << "\n";
-    std::cout << "3. Quantidade de arcos: " << contarArcos() << "\n";
-    std::cout << "4. Quantidade de vertices requeridos: " << contarVerticesRequeridos() << "\n";
-    std::cout << "5. Quantidade de arestas requeridas: " << contarArestasRequeridas() << "\n";
-    std::cout << "6. Quantidade de arcos requeridos: " << contarArcosRequeridos() << "\n";
-    std::cout << "7. Densidade do grafo: " << calcularDensidade() << "\n";
-    std::cout << "8. Componentes conexas: " << contarComponentesConexas() << "\n";
-    std::cout << "9. Grau minimo: " << grauMinimo() << "\n";
-    std::cout << "10. Grau maximo: " << grauMaximo() << "\n";
-
-    auto intermedia = calcularIntermediacao();
-    for (int i = 1; i <= num_vertices; ++i)
-        std::cout << "11. Intermediacao vertice " << i << ": " << intermedia[i] << "\n";
-
-    std::cout << "12. Caminho medio: " << calcularCaminhoMedio() << "\n";
-    std::cout << "13. Diametro: " << calcularDiametro() << "\n";
-}
-
-void salvarEstatisticasEmArquivo(const std::string &nome_arquivo)
-{
-    std::ofstream out(nome_arquivo);
-
-    out << "1. Quantidade de vertices: " << contarVertices() << "\n";
-    out << "2. Quantidade de arestas: " << contarArestas() << "\n";
-    out << "3. Quantidade de arcos: " << contarArcos() << "\n";
-    out << "4. Quantidade de vertices requeridos: " << contarVerticesRequeridos() << "\n";
-    out << "5. Quantidade de arestas requeridas: " << contarArestasRequeridas() << "\n";
-    out << "6. Quantidade de arcos requeridos: " << contarArcosRequeridos() << "\n";
-    out << "7. Densidade do grafo: " << calcularDensidade() << "\n";
-    out << "8. Componentes conexas: " << contarComponentesConexas() << "\n";
-    out << "9. Grau minimo: " << grauMinimo() << "\n";
-    out << "10. Grau maximo: " << grauMaximo() << "\n";
-
-    auto intermedia = calcularIntermediacao();
-    for (int i = 1; i <= num_vertices; ++i)
-        out << "11. Intermediacao vertice " << i << ": " << intermedia[i] << "\n";
-
-    out << "12. Caminho medio: " << calcularCaminhoMedio() << "\n";
-    out << "13. Diametro: " << calcularDiametro() << "\n";
 
-    out.close();
-}
+    if (lote)
+    {
+        if (configLote.caminhos.empty())
+            configLote.caminhos.push_back("dados");
+        if (configLote.metricas.empty())
+            lerMetricas("todas", configLote.metricas);
+        return executarLote(configLote);
+    }
 
-void menu()
-{
-    std::cout << "\nEscolha uma opcao para calcular (1 a 13) ou 0 para sair:\n";
-    std::cout << "1. Quantidade de vertices\n";
-    std::cout << "2. Quantidade de arestas\n";
-    std::cout << "3. Quantidade de arcos\n";
-    std::cout << "4. Quantidade de vertices requeridos\n";
-    std::cout << "5. Quantidade de arestas requeridas\n";
-    std::cout << "6. Quantidade de arcos requeridos\n";
-    std::cout << "7. Densidade do grafo\n";
-    std::cout << "8. Componentes conectados\n";
-    std::cout << "9. Grau minimo dos vertices\n";
-    std::cout << "10. Grau maximo dos vertices\n";
-    std::cout << "11. Intermediacao de cada vertice\n";
-    std::cout << "12. Caminho medio\n";
-    std::cout << "13. Diametro\n";
-    std::cout << "14. Mostrar todas as estatisticas\n";
-    std::cout << "0. Sair\n> ";
-}
+    if (!lerArquivo("DI-NEARP-n422-Q8k.dat", reordenar))
+        return 1;
+    if (configLote.aproximado)
+        estatisticas->usarAproximacao(configLote.aproximacao);
 
-int main()
-{
-    lerArquivo("DI-NEARP-n422-Q8k.dat");
-    floydWarshall();
-    salvarEstatisticasEmArquivo("saida.txt");
+    // O saida.txt só é gerado pela opção 14 ou ao sair: as opções 1 a 10 não
+    // disparam a passada de caminhos mínimos
 
     int opcao;
     do
     {
         menu();
-        std::cin >> opcao;
+        // Fim da entrada encerra como a opção 0
+        if (!(std::cin >> opcao))
+            opcao = 0;
 
         switch (opcao)
         {
@@ -494,23 +635,21 @@ int main()
             std::cout << "Grau maximo: " << grauMaximo() << "\n";
             break;
         case 11:
-        {
-            auto intermedia = calcularIntermediacao();
-            for (int i = 1; i <= num_vertices; ++i)
-                std::cout << "Intermediacao vertice " << i << ": " << intermedia[i] << "\n";
+            escreverIntermediacao(std::cout, "");
             break;
-        }
         case 12:
-            std::cout << "Caminho medio: " << calcularCaminhoMedio() << "\n";
+            escreverCaminhoMedio(std::cout, "");
             break;
         case 13:
-            std::cout << "Diametro: " << calcularDiametro() << "\n";
+            escreverDiametro(std::cout, "");
             break;
         case 14:
             exibirTodasEstatisticas();
+            salvarEstatisticasEmArquivo("saida.txt");
             break;
 
         case 0:
+            salvarEstatisticasEmArquivo("saida.txt");
             std::cout << "Encerrando...\n";
             break;
         default: